@@ -22,9 +22,17 @@
 #include <bitcoin/server/server_node.hpp>
 #include <bitcoin/server/settings.hpp>
 #include <bitcoin/server/version.hpp>
+#include <bitcoin/server/indexes/address_index.hpp>
+#include <bitcoin/server/indexes/chain_index.hpp>
+#include <bitcoin/server/indexes/filter_index.hpp>
+#include <bitcoin/server/indexes/header_index.hpp>
+#include <bitcoin/server/indexes/mempool_index.hpp>
+#include <bitcoin/server/indexes/script_index.hpp>
 #include <bitcoin/server/interface/address.hpp>
 #include <bitcoin/server/interface/blockchain.hpp>
 #include <bitcoin/server/interface/protocol.hpp>
+#include <bitcoin/server/interface/statistics.hpp>
+#include <bitcoin/server/interface/transaction.hpp>
 #include <bitcoin/server/interface/transaction_pool.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/messages/route.hpp>
@@ -32,9 +40,19 @@
 #include <bitcoin/server/services/heartbeat_service.hpp>
 #include <bitcoin/server/services/query_service.hpp>
 #include <bitcoin/server/services/transaction_service.hpp>
+#include <bitcoin/server/utility/account_scanner.hpp>
 #include <bitcoin/server/utility/address_key.hpp>
 #include <bitcoin/server/utility/authenticator.hpp>
+#include <bitcoin/server/utility/block_filter.hpp>
+#include <bitcoin/server/utility/confirmation_watches.hpp>
+#include <bitcoin/server/utility/fee_estimator.hpp>
+#include <bitcoin/server/utility/fee_histogram.hpp>
 #include <bitcoin/server/utility/fetch_helpers.hpp>
+#include <bitcoin/server/utility/histogram.hpp>
+#include <bitcoin/server/utility/merkle_cache.hpp>
+#include <bitcoin/server/utility/relay_monitor.hpp>
+#include <bitcoin/server/utility/status_monitor.hpp>
+#include <bitcoin/server/utility/verdict_cache.hpp>
 #include <bitcoin/server/workers/notification_worker.hpp>
 #include <bitcoin/server/workers/query_worker.hpp>
 
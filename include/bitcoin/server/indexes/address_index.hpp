@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_ADDRESS_INDEX_HPP
+#define LIBBITCOIN_SERVER_ADDRESS_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/configuration.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/indexes/chain_index.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+class server_node;
+
+// This class is thread safe.
+// Maintain the confirmed received and spent totals and the unspent outputs of
+// each address hash. Outputs below the index start height are not counted,
+// nor are their spends.
+class BCS_API address_index
+  : public chain_index
+{
+public:
+    struct unspent_output
+    {
+        chain::output_point point;
+        uint64_t value;
+        size_t height;
+    };
+
+    typedef std::vector<unspent_output> unspent_list;
+
+    /// Construct an address index.
+    address_index(server_node& node, const configuration& configuration);
+
+    /// The totals of the address hash and the height at which they apply.
+    /// Returns false if no block has been indexed.
+    bool balance(const short_hash& hash, size_t& height, uint64_t& received,
+        uint64_t& spent) const;
+
+    /// The unspent outputs of the address hash, ordered by point.
+    /// Returns false if no block has been indexed.
+    bool unspent(const short_hash& hash, size_t& height,
+        unspent_list& outputs) const;
+
+protected:
+    void prepare(block_const_ptr block, size_t height,
+        result_handler handler) override;
+    bool connect(block_const_ptr block, size_t height) override;
+    bool disconnect(block_const_ptr block, size_t height) override;
+    void reset() override;
+
+private:
+    struct totals
+    {
+        uint64_t received;
+        uint64_t spent;
+    };
+
+    // Points are ordered as (hash, index) for deterministic results.
+    typedef std::pair<hash_digest, uint32_t> point_key;
+
+    struct output_row
+    {
+        uint64_t value;
+        size_t height;
+    };
+
+    // A previous output spent by the block, a null hash if not indexed.
+    struct spend
+    {
+        short_hash hash;
+        point_key point;
+        output_row output;
+    };
+
+    struct prepared
+    {
+        hash_digest block_hash;
+        std::vector<spend> spends;
+    };
+
+    typedef std::shared_ptr<std::vector<spend>> spends_ptr;
+    typedef std::unordered_map<short_hash, totals> totals_map;
+    typedef std::map<point_key, output_row> outputs_map;
+    typedef std::unordered_map<short_hash, outputs_map> unspent_map;
+
+    // The data required to disconnect a block.
+    struct undo
+    {
+        totals_map totals;
+        std::vector<spend> spends;
+    };
+
+    void handle_prevout(const code& ec, transaction_const_ptr tx,
+        size_t tx_height, const chain::output_point& prevout, size_t slot,
+        spends_ptr spends, result_handler complete);
+    void handle_prepared(const code& ec, block_const_ptr block,
+        size_t height, spends_ptr spends, result_handler handler);
+
+    // These are protected by the base mutex.
+    totals_map totals_;
+    unspent_map unspent_;
+    std::deque<undo> undo_;
+
+    // These are protected by prepared mutex.
+    std::map<size_t, prepared> prepared_;
+    mutable shared_mutex prepared_mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
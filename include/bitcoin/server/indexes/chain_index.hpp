@@ -0,0 +1,149 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_CHAIN_INDEX_HPP
+#define LIBBITCOIN_SERVER_CHAIN_INDEX_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/configuration.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+class server_node;
+
+// This class is thread safe.
+// Follow the chain from the index start height, connecting blocks in order
+// and disconnecting them upon reorganization. Blocks are read from the store
+// in windows that are fetched and prepared concurrently and then connected
+// in order. Derived classes guard index reads with a shared lock on mutex_,
+// which is held exclusively during connect, disconnect and reset. A derived
+// index may restore persisted data on start, which is rebuilt if its top
+// block is no longer of the chain. A headers only index reads just headers
+// from the store, connecting each as a block without transactions.
+class BCS_API chain_index
+{
+public:
+    /// Construct a chain index from the configured index start height.
+    chain_index(server_node& node, const configuration& configuration,
+        const std::string& name);
+
+    /// Construct a chain index from the start height.
+    chain_index(server_node& node, const configuration& configuration,
+        const std::string& name, size_t start_height, bool headers_only);
+
+    /// This class is not copyable.
+    chain_index(const chain_index&) = delete;
+    void operator=(const chain_index&) = delete;
+
+    /// Subscribe to reorganizations and index from the start height.
+    bool start();
+
+    /// True if the index has been brought up to the top of the chain.
+    bool synchronized() const;
+
+    /// The height of the top indexed block, false if none is indexed.
+    bool top(size_t& height) const;
+
+protected:
+    /// Restore persisted index data before the scan (no lock).
+    /// Returns the number of blocks restored and sets the top block hash.
+    virtual size_t load(hash_digest& top_hash);
+
+    /// Resolve the data required to connect a block (any order, no lock).
+    virtual void prepare(block_const_ptr block, size_t height,
+        result_handler handler);
+
+    /// Apply a prepared block at the top of the index.
+    virtual bool connect(block_const_ptr block, size_t height) = 0;
+
+    /// Reverse the block at the top of the index.
+    /// Returns false if the block is deeper than the retained undo data.
+    virtual bool disconnect(block_const_ptr block, size_t height) = 0;
+
+    /// Discard all index data in preparation for a rebuild.
+    virtual void reset() = 0;
+
+    /// The height of the top indexed block, caller must hold the mutex.
+    bool indexed_top(size_t& height) const;
+
+    /// Connect prepared blocks from the first height while each links to the
+    /// top, caller must hold the mutex. Returns the number connected.
+    size_t link(const block_const_ptr_list& blocks, size_t first);
+
+    /// Disconnect the blocks of an outgoing branch from the top, caller must
+    /// hold the mutex. Returns false if the index was reset for a rebuild.
+    bool unlink(size_t fork_height, const block_const_ptr_list& old_blocks);
+
+    // These are thread safe.
+    server_node& node_;
+    const size_t start_height_;
+    const size_t depth_;
+    dispatcher dispatch_;
+
+    // Index data is protected by this mutex.
+    mutable shared_mutex mutex_;
+
+private:
+    typedef std::shared_ptr<block_const_ptr_list> block_list_ptr;
+
+    void catch_up();
+    void scan();
+    void finish_scan();
+    void fetch(size_t height, block_list_ptr blocks, size_t index,
+        result_handler complete);
+    void fetch_header(size_t height, block_list_ptr blocks, size_t index,
+        result_handler complete);
+
+    void handle_restored(const code& ec, header_const_ptr header,
+        const hash_digest& top_hash);
+    void handle_last_height(const code& ec, size_t height);
+    void handle_block(const code& ec, block_const_ptr block, size_t height,
+        block_list_ptr blocks, size_t index, result_handler complete);
+    void handle_header(const code& ec, header_const_ptr header, size_t height,
+        block_list_ptr blocks, size_t index, result_handler complete);
+    void handle_window(const code& ec, block_list_ptr blocks, size_t first,
+        size_t epoch);
+    bool handle_reorganization(const code& ec, size_t fork_height,
+        block_const_ptr_list_const_ptr new_blocks,
+        block_const_ptr_list_const_ptr old_blocks);
+
+    // These are thread safe.
+    const std::string name_;
+    const bool headers_only_;
+    const size_t window_size_;
+    std::atomic<bool> synchronized_;
+
+    // These are protected by mutex.
+    size_t next_;
+    size_t window_end_;
+    size_t epoch_;
+    bool scanning_;
+    bool pending_;
+    hash_digest top_hash_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
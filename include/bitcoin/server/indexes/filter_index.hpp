@@ -0,0 +1,122 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_FILTER_INDEX_HPP
+#define LIBBITCOIN_SERVER_FILTER_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <vector>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/configuration.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/indexes/chain_index.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+class server_node;
+
+// This class is thread safe.
+// Maintain the BIP158 basic filter and BIP157 filter header of each block
+// from the index start height. Filters are appended to a file in the database
+// directory and restored from it on start. Filter headers chain from a null
+// hash at the start height, so only match BIP157 for a start height of zero.
+class BCS_API filter_index
+  : public chain_index
+{
+public:
+    struct header_row
+    {
+        hash_digest block_hash;
+        hash_digest filter_header;
+    };
+
+    struct filter_row
+    {
+        hash_digest block_hash;
+        hash_digest filter_header;
+        data_chunk filter;
+    };
+
+    typedef std::vector<header_row> header_list;
+    typedef std::vector<filter_row> filter_list;
+
+    /// Construct a filter index.
+    filter_index(server_node& node, const configuration& configuration);
+
+    /// The filter headers of up to count blocks from the height.
+    /// Returns false if the block at the height is not indexed.
+    bool headers(size_t height, size_t count, header_list& out) const;
+
+    /// The filters of up to count blocks from the height.
+    /// Returns false if the block at the height is not indexed.
+    bool filters(size_t height, size_t count, filter_list& out) const;
+
+protected:
+    size_t load(hash_digest& top_hash) override;
+    void prepare(block_const_ptr block, size_t height,
+        result_handler handler) override;
+    bool connect(block_const_ptr block, size_t height) override;
+    bool disconnect(block_const_ptr block, size_t height) override;
+    void reset() override;
+
+private:
+    // The location of a filter in the file.
+    struct entry
+    {
+        hash_digest block_hash;
+        hash_digest filter_header;
+        uint64_t offset;
+        uint32_t size;
+    };
+
+    struct prepared
+    {
+        hash_digest block_hash;
+        data_chunk filter;
+    };
+
+    typedef std::shared_ptr<data_stack> scripts_ptr;
+
+    bool open(uint64_t size);
+    void handle_prevout(const code& ec, transaction_const_ptr tx,
+        const chain::output_point& prevout, size_t slot, scripts_ptr scripts,
+        result_handler complete);
+    void handle_prepared(const code& ec, block_const_ptr block,
+        size_t height, scripts_ptr scripts, result_handler handler);
+
+    // This is thread safe.
+    const boost::filesystem::path path_;
+
+    // These are protected by the base mutex.
+    std::vector<entry> entries_;
+    std::ofstream file_;
+
+    // These are protected by prepared mutex.
+    std::map<size_t, prepared> prepared_;
+    mutable shared_mutex prepared_mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_HEADER_INDEX_HPP
+#define LIBBITCOIN_SERVER_HEADER_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/configuration.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/indexes/chain_index.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+class server_node;
+
+// This class is thread safe.
+// Hold the serialized header of each block of the chain from genesis in one
+// contiguous array, with the median time past of each block. Headers are
+// read from the store in windows of the chain index headers only scan.
+// Median time past is monotone in height, so it is searchable by time.
+class BCS_API header_index
+  : public chain_index
+{
+public:
+    /// Construct a header index.
+    header_index(server_node& node, const configuration& configuration);
+
+    /// Append up to count headers from the height to out, setting the count.
+    /// Returns false if the header at the height is not indexed.
+    bool headers(size_t height, size_t count, data_chunk& out,
+        size_t& appended) const;
+
+    /// The height of the first block with median time past at or after time.
+    /// Returns false if there is no such block indexed.
+    bool height_by_time(uint32_t time, size_t& height) const;
+
+protected:
+    bool connect(block_const_ptr block, size_t height) override;
+    bool disconnect(block_const_ptr block, size_t height) override;
+    void reset() override;
+
+private:
+    size_t count() const;
+    void truncate(size_t count);
+
+    // These are protected by mutex.
+    data_chunk headers_;
+    std::vector<uint32_t> median_times_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_MEMPOOL_INDEX_HPP
+#define LIBBITCOIN_SERVER_MEMPOOL_INDEX_HPP
+
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+class server_node;
+
+// This class is thread safe.
+// Maintain the history rows of unconfirmed transactions by address hash, in
+// the form of the confirmed history with a zero height. Transactions are
+// added as accepted to the pool or as reorganized out of the chain, and
+// removed as confirmed. The pool may drop a transaction without notice, so
+// each is also removed once older than the lifetime, checked on each block.
+class BCS_API mempool_index
+{
+public:
+    /// Construct a mempool index.
+    mempool_index(server_node& node, const asio::duration& lifetime);
+
+    /// This class is not copyable.
+    mempool_index(const mempool_index&) = delete;
+    void operator=(const mempool_index&) = delete;
+
+    /// Subscribe to pool acceptances and chain reorganizations.
+    bool start();
+
+    /// Append the unconfirmed history rows of the address hash to out.
+    void history(const short_hash& hash,
+        chain::history_compact::list& out) const;
+
+    /// Index the pooled transaction until removed or expired.
+    void add(const chain::transaction& tx, const asio::time_point& expiry);
+
+    /// Stop indexing the transaction, if indexed.
+    void remove(const hash_digest& tx_hash);
+
+    /// Stop indexing the transactions expired at the time.
+    void purge(const asio::time_point& now);
+
+    /// Restore the outgoing branch to the index and remove the incoming.
+    void reorganize(const block_const_ptr_list& new_blocks,
+        const block_const_ptr_list& old_blocks, const asio::time_point& now);
+
+private:
+    typedef std::unordered_map<short_hash, chain::history_compact::list>
+        history_map;
+    typedef std::pair<std::vector<short_hash>, asio::time_point> entry;
+    typedef std::unordered_map<hash_digest, entry> address_map;
+    typedef std::deque<std::pair<hash_digest, asio::time_point>> entry_queue;
+
+    // These require the exclusive mutex.
+    void insert(const chain::transaction& tx,
+        const asio::time_point& expiry);
+    void append(const short_hash& hash, const chain::history_compact& row,
+        std::vector<short_hash>& addresses);
+    void erase(const hash_digest& tx_hash);
+    void expire(const asio::time_point& now);
+
+    bool handle_reorganization(const code& ec, size_t fork_height,
+        block_const_ptr_list_const_ptr new_blocks,
+        block_const_ptr_list_const_ptr old_blocks);
+    bool handle_transaction(const code& ec, transaction_const_ptr tx);
+
+    // These are thread safe.
+    server_node& node_;
+    const asio::duration lifetime_;
+
+    // These are protected by mutex (queue is oldest first).
+    history_map history_;
+    address_map addresses_;
+    entry_queue queue_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_SCRIPT_INDEX_HPP
+#define LIBBITCOIN_SERVER_SCRIPT_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/configuration.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/indexes/chain_index.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+class server_node;
+
+// This class is thread safe.
+// Maintain the confirmed history and the received and spent totals of each
+// output script, keyed by the sha256 hash of the script. This serves script
+// hash and witness outputs and bare scripts, which have no payment address.
+// Outputs below the index start height are not indexed, nor are their spends.
+class BCS_API script_index
+  : public chain_index
+{
+public:
+    /// The hash by which an output script is indexed.
+    static hash_digest to_script_hash(const chain::script& script);
+
+    /// Construct a script index.
+    script_index(server_node& node, const configuration& configuration);
+
+    /// The history of the script hash at and above the from height, in
+    /// height order, and the height at which it applies.
+    /// Returns false if no block has been indexed.
+    bool history(const hash_digest& script_hash, size_t from_height,
+        size_t& height, chain::history_compact::list& out) const;
+
+    /// The totals of the script hash and the height at which they apply.
+    /// Returns false if no block has been indexed.
+    bool balance(const hash_digest& script_hash, size_t& height,
+        uint64_t& received, uint64_t& spent) const;
+
+protected:
+    void prepare(block_const_ptr block, size_t height,
+        result_handler handler) override;
+    bool connect(block_const_ptr block, size_t height) override;
+    bool disconnect(block_const_ptr block, size_t height) override;
+    void reset() override;
+
+private:
+    struct totals
+    {
+        uint64_t received;
+        uint64_t spent;
+    };
+
+    // A previous output spent by the block, a null hash if not indexed.
+    struct spend
+    {
+        hash_digest script_hash;
+        uint64_t value;
+    };
+
+    struct prepared
+    {
+        hash_digest block_hash;
+        std::vector<spend> spends;
+    };
+
+    typedef std::shared_ptr<std::vector<spend>> spends_ptr;
+    typedef std::unordered_map<hash_digest, totals> totals_map;
+    typedef std::unordered_map<hash_digest, chain::history_compact::list>
+        history_map;
+
+    void add(const hash_digest& script_hash,
+        const chain::history_compact& row, totals_map& record);
+    void handle_prevout(const code& ec, transaction_const_ptr tx,
+        size_t tx_height, const chain::output_point& prevout, size_t slot,
+        spends_ptr spends, result_handler complete);
+    void handle_prepared(const code& ec, block_const_ptr block,
+        size_t height, spends_ptr spends, result_handler handler);
+
+    // These are protected by the base mutex.
+    // The totals of each block are retained for disconnection.
+    history_map history_;
+    totals_map totals_;
+    std::deque<totals_map> undo_;
+
+    // These are protected by prepared mutex.
+    std::map<size_t, prepared> prepared_;
+    mutable shared_mutex prepared_mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -39,6 +39,14 @@ public:
     static void unsubscribe2(server_node& node, const message& request,
         send_handler handler);
 
+    /// Subscribe to notifications of outputs to and spends of a script hash.
+    static void subscribe_script(server_node& node, const message& request,
+        send_handler handler);
+
+    /// Unsubscribe to notifications of outputs to and spends of a script hash.
+    static void unsubscribe_script(server_node& node,
+        const message& request, send_handler handler);
+
 private:
     static bool unwrap_subscribe2_args(binary& prefix_filter,
         const message& request);
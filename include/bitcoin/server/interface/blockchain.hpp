@@ -20,10 +20,13 @@
 #define LIBBITCOIN_SERVER_BLOCKCHAIN_HPP
 
 #include <cstddef>
+#include <memory>
 #include <bitcoin/blockchain.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/server_node.hpp>
+#include <bitcoin/server/utility/account_scanner.hpp>
+#include <bitcoin/server/utility/merkle_cache.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -42,10 +45,18 @@ public:
     static void fetch_transaction(server_node& node,
         const message& request, send_handler handler);
 
+    /// Fetch a list of transactions from the blockchain by their hashes.
+    static void fetch_transactions(server_node& node,
+        const message& request, send_handler handler);
+
     /// Fetch the current height of the blockchain.
     static void fetch_last_height(server_node& node,
         const message& request, send_handler handler);
 
+    /// Fetch a block by hash or height.
+    static void fetch_block(server_node& node,
+        const message& request, send_handler handler);
+
     /// Fetch a block header by hash or height (conditional serialization).
     static void fetch_block_header(server_node& node,
         const message& request, send_handler handler);
@@ -54,6 +65,10 @@ public:
     static void fetch_block_transaction_hashes(server_node& node,
         const message& request, send_handler handler);
 
+    /// Fetch the merkle branch of a confirmed transaction.
+    static void fetch_merkle_proof(server_node& node,
+        const message& request, send_handler handler);
+
     /// Fetch the block index of a transaction and the height of its block.
     static void fetch_transaction_index(server_node& node,
         const message& request, send_handler handler);
@@ -62,6 +77,18 @@ public:
     static void fetch_spend(server_node& node,
         const message& request, send_handler handler);
 
+    /// Fetch the inpoints which spend each of a list of outputs.
+    static void fetch_spends(server_node& node,
+        const message& request, send_handler handler);
+
+    /// Fetch a range of block headers.
+    static void fetch_block_headers(server_node& node,
+        const message& request, send_handler handler);
+
+    /// Fetch the height of the first block with median time past at a time.
+    static void fetch_height_by_time(server_node& node,
+        const message& request, send_handler handler);
+
     /// Fetch the height of a block by its hash.
     static void fetch_block_height(server_node& node,
         const message& request, send_handler handler);
@@ -74,6 +101,42 @@ public:
     static void fetch_stealth_transaction(server_node& node,
         const message& request, send_handler handler);
 
+    /// Fetch the confirmed received and spent totals of an address hash.
+    static void fetch_balance(server_node& node,
+        const message& request, send_handler handler);
+
+    /// Fetch the confirmed unspent outputs of an address hash.
+    static void fetch_unspent(server_node& node,
+        const message& request, send_handler handler);
+
+    /// Fetch the confirmed history of an output script hash.
+    static void fetch_script_history(server_node& node,
+        const message& request, send_handler handler);
+
+    /// Fetch the confirmed received and spent totals of a script hash.
+    static void fetch_script_balance(server_node& node,
+        const message& request, send_handler handler);
+
+    /// Fetch the compact filter of a block.
+    static void fetch_filter(server_node& node,
+        const message& request, send_handler handler);
+
+    /// Fetch the compact filter headers of a range of blocks.
+    static void fetch_filter_headers(server_node& node,
+        const message& request, send_handler handler);
+
+    /// Fetch the compact filters of a range of blocks.
+    static void fetch_filters(server_node& node,
+        const message& request, send_handler handler);
+
+    /// Fetch the used addresses and histories of an extended public key.
+    static void fetch_account_history(server_node& node,
+        const message& request, send_handler handler);
+
+    /// Estimate the fee rate to confirm within a number of blocks.
+    static void estimate_fee(server_node& node,
+        const message& request, send_handler handler);
+
     /// Save to blockchain and announce to all connected peers.
     static void broadcast(server_node& node, const message& request,
         send_handler handler);
@@ -83,9 +146,22 @@ public:
         send_handler handler);
 
 private:
+    static void account_history_fetched(const code& ec,
+        const account_scanner::list& used, const message& request,
+        send_handler handler);
+
     static void last_height_fetched(const code& ec, size_t last_height,
         const message& request, send_handler handler);
 
+    static void fetch_block_by_hash(server_node& node,
+        const message& request, send_handler handler);
+
+    static void fetch_block_by_height(server_node& node,
+        const message& request, send_handler handler);
+
+    static void block_fetched(const code& ec, block_const_ptr block,
+        size_t height, const message& request, send_handler handler);
+
     static void fetch_block_header_by_hash(server_node& node,
         const message& request, send_handler handler);
 
@@ -105,6 +181,24 @@ private:
     static void merkle_block_fetched(const code& ec, merkle_block_ptr block,
         size_t height, const message& request, send_handler handler);
 
+    static void proof_position_fetched(server_node& node, const code& ec,
+        size_t tx_position, size_t block_height, const hash_digest& tx_hash,
+        const message& request, send_handler handler);
+
+    static void proof_header_fetched(server_node& node, const code& ec,
+        header_const_ptr header, size_t block_height, size_t tx_position,
+        const hash_digest& tx_hash, const message& request,
+        send_handler handler);
+
+    static void proof_block_fetched(server_node& node, const code& ec,
+        merkle_block_ptr block, size_t block_height, size_t tx_position,
+        const hash_digest& tx_hash, const message& request,
+        send_handler handler);
+
+    static void send_merkle_proof(const merkle_cache::tree& tree,
+        size_t block_height, size_t tx_position, const hash_digest& tx_hash,
+        const message& request, send_handler handler);
+
     static void transaction_index_fetched(const code& ec,
         size_t tx_position, size_t block_height, const message& request,
         send_handler handler);
@@ -113,6 +207,18 @@ private:
         const chain::input_point& inpoint, const message& request,
         send_handler handler);
 
+    static void fetch_spend_item(server_node& node,
+        const chain::output_point& outpoint, size_t slot,
+        std::shared_ptr<data_chunk> items, result_handler complete);
+
+    static void spend_item_fetched(const code& ec,
+        const chain::input_point& inpoint, size_t slot,
+        std::shared_ptr<data_chunk> items, result_handler complete);
+
+    static void spends_fetched(const code& ec,
+        std::shared_ptr<data_chunk> items, const message& request,
+        send_handler handler);
+
     static void block_height_fetched(const code& ec, size_t block_height,
         const message& request, send_handler handler);
 
@@ -127,7 +233,15 @@ private:
     static void handle_broadcast(const code& ec, const message& request,
         send_handler handler);
 
-    static void handle_validated(const code& ec, const message& request,
+    static void handle_validate_height(server_node& node, const code& ec,
+        size_t height, const message& request, send_handler handler);
+
+    static void handle_validate_header(server_node& node, const code& ec,
+        header_const_ptr header, const message& request,
+        send_handler handler);
+
+    static void handle_validated(server_node& node, const code& ec,
+        const hash_digest& key, const message& request,
         send_handler handler);
 };
 
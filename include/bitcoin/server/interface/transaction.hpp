@@ -0,0 +1,52 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_TRANSACTION_HPP
+#define LIBBITCOIN_SERVER_TRANSACTION_HPP
+
+#include <cstdint>
+#include <vector>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+#include <bitcoin/server/server_node.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// Transaction interface.
+/// Class and method names are published and mapped to the zeromq interface.
+class BCS_API transaction
+{
+public:
+    /// Subscribe to notifications of confirmation depths of a transaction.
+    static void subscribe_confirmations(server_node& node,
+        const message& request, send_handler handler);
+
+    /// Unsubscribe to confirmation depth notifications of a transaction.
+    static void unsubscribe_confirmations(server_node& node,
+        const message& request, send_handler handler);
+
+private:
+    static bool unwrap_subscribe_confirmations_args(hash_digest& tx_hash,
+        std::vector<uint32_t>& depths, const message& request);
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
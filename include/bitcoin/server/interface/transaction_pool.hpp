@@ -19,6 +19,10 @@
 #ifndef LIBBITCOIN_SERVER_TRANSACTION_POOL_HPP
 #define LIBBITCOIN_SERVER_TRANSACTION_POOL_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/messages/message.hpp>
@@ -36,16 +40,82 @@ public:
     static void fetch_transaction(server_node& node, const message& request,
         send_handler handler);
 
+    /// Fetch a list of transactions from the pool (or chain), by hashes.
+    static void fetch_transactions(server_node& node,
+        const message& request, send_handler handler);
+
+    /// Fetch the unconfirmed and confirmed history of an address.
+    static void fetch_history(server_node& node, const message& request,
+        send_handler handler);
+
+    /// Fetch the previous outputs and fee of a transaction, or its hash.
+    static void fetch_prevouts(server_node& node, const message& request,
+        send_handler handler);
+
+    /// Fetch the fee rate distribution of the transaction pool.
+    static void fetch_fee_histogram(server_node& node,
+        const message& request, send_handler handler);
+
+    /// Fetch the transactions seen since start and not yet confirmed,
+    /// accepted after a sequence, streamed. This is not the node's pool.
+    static void fetch_snapshot(server_node& node, const message& request,
+        send_handler handler);
+
     /// Save to tx pool and announce to all connected peers.
     static void broadcast(server_node& node, const message& request,
         send_handler handler);
 
+    /// Save a list of transactions to tx pool, parents first, and announce.
+    static void broadcast_transactions(server_node& node,
+        const message& request, send_handler handler);
+
     /// Validate a transaction against the transaction pool and blockchain.
     static void validate2(server_node& node, const message& request,
         send_handler handler);
 
 private:
-    static void handle_broadcast(const code& ec, const message& request,
+    struct broadcast_batch;
+    typedef std::shared_ptr<broadcast_batch> batch_ptr;
+    struct prevout_query;
+    typedef std::shared_ptr<prevout_query> query_ptr;
+    typedef std::shared_ptr<std::vector<data_chunk>> items_ptr;
+
+    static void snapshot_item_fetched(const code& ec, transaction_ptr tx,
+        size_t slot, items_ptr items, result_handler complete);
+    static void snapshot_fetched(const code& ec, uint64_t sequence,
+        items_ptr items, const message& request, send_handler handler);
+    static void send_snapshot(uint64_t sequence,
+        const std::vector<data_chunk>& items, const message& request,
+        send_handler handler);
+
+    static void resolve_prevouts(server_node& node, const code& ec,
+        transaction_const_ptr tx, const message& request,
+        send_handler handler);
+    static void fetch_prevout(server_node& node, size_t slot,
+        query_ptr query, result_handler complete);
+    static void handle_prevout(const code& ec, transaction_const_ptr tx,
+        size_t height, size_t position, size_t slot, query_ptr query,
+        result_handler complete);
+    static void prevouts_resolved(const code& ec, query_ptr query,
+        const message& request, send_handler handler);
+
+    static void check_batch_item(const data_chunk& payload, size_t slot,
+        batch_ptr batch, result_handler complete);
+    static void batch_checked(server_node& node, const code& ec,
+        batch_ptr batch, const message& request, send_handler handler);
+    static void organize_batch_item(server_node& node, size_t index,
+        batch_ptr batch, const message& request, send_handler handler);
+    static void batch_item_organized(server_node& node, const code& ec,
+        size_t index, batch_ptr batch, const message& request,
+        send_handler handler);
+
+    static void history_fetched(server_node& node, const code& ec,
+        const chain::history_compact::list& history,
+        const short_hash& address_hash, const message& request,
+        send_handler handler);
+
+    static void handle_broadcast(server_node& node, const code& ec,
+        const hash_digest& key, const message& request,
         send_handler handler);
 
     static void handle_validated2(const code& ec, const message& request,
@@ -21,10 +21,16 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 #include <bitcoin/node.hpp>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/configuration.hpp>
 #include <bitcoin/server/define.hpp>
+#include <bitcoin/server/indexes/address_index.hpp>
+#include <bitcoin/server/indexes/filter_index.hpp>
+#include <bitcoin/server/indexes/header_index.hpp>
+#include <bitcoin/server/indexes/mempool_index.hpp>
+#include <bitcoin/server/indexes/script_index.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/messages/route.hpp>
 #include <bitcoin/server/services/block_service.hpp>
@@ -32,6 +38,11 @@
 #include <bitcoin/server/services/query_service.hpp>
 #include <bitcoin/server/services/transaction_service.hpp>
 #include <bitcoin/server/utility/authenticator.hpp>
+#include <bitcoin/server/utility/fee_estimator.hpp>
+#include <bitcoin/server/utility/fee_histogram.hpp>
+#include <bitcoin/server/utility/merkle_cache.hpp>
+#include <bitcoin/server/utility/status_monitor.hpp>
+#include <bitcoin/server/utility/verdict_cache.hpp>
 #include <bitcoin/server/workers/notification_worker.hpp>
 
 namespace libbitcoin {
@@ -60,6 +71,48 @@ public:
     /// Server configuration settings.
     virtual const settings& server_settings() const;
 
+    /// Dispatcher for the concurrent lookups of batch queries.
+    virtual dispatcher& query_dispatch();
+
+    /// Chain tip, pool size and query load monitor.
+    virtual status_monitor& status();
+
+    /// Fee rate distribution of the transaction pool.
+    virtual const fee_histogram& pool_fees() const;
+
+    /// Fee rate estimates from confirmation history.
+    virtual const fee_estimator& fee_estimates() const;
+
+    /// Block publication relay accounting.
+    virtual const relay_monitor& block_relay(bool secure) const;
+
+    /// Transaction publication relay accounting.
+    virtual const relay_monitor& transaction_relay(bool secure) const;
+
+    /// Address balance and unspent output index, valid if enabled.
+    virtual const address_index& addresses() const;
+
+    /// Compact block filter index, valid if enabled.
+    virtual const filter_index& filters() const;
+
+    /// Block header array, valid if enabled.
+    virtual const header_index& headers() const;
+
+    /// Unconfirmed address history index, valid if enabled.
+    virtual const mempool_index& mempool() const;
+
+    /// Script hash history and balance index, valid if enabled.
+    virtual const script_index& scripts() const;
+
+    /// Recently built block merkle trees.
+    virtual merkle_cache& merkle_trees();
+
+    /// Recently accepted transaction broadcasts, by payload hash.
+    virtual verdict_cache& broadcasts();
+
+    /// Recent validation verdicts, by payload and chain top hash.
+    virtual verdict_cache& validations();
+
     // Run sequence.
     // ------------------------------------------------------------------------
 
@@ -87,6 +140,15 @@ public:
     virtual code subscribe_address(const route& reply_to, uint32_t id,
         const binary& prefix_filter, bool unsubscribe);
 
+    /// Subscribe to notifications of outputs to and spends of a script hash.
+    virtual code subscribe_script(const route& reply_to, uint32_t id,
+        const hash_digest& script_hash, bool unsubscribe);
+
+    /// Subscribe to confirmation depth notifications of a transaction.
+    virtual code subscribe_confirmations(const route& reply_to, uint32_t id,
+        const hash_digest& tx_hash, const std::vector<uint32_t>& depths,
+        bool unsubscribe);
+
     /////// Subscribe to transaction penetration notifications.
     ////virtual void subscribe_penetration(const route& reply_to, uint32_t id,
     ////    const hash_digest& tx_hash);
@@ -95,6 +157,9 @@ private:
     void handle_running(const code& ec, result_handler handler);
 
     bool start_services();
+    bool start_status();
+    bool start_indexes();
+    bool start_caches();
     bool start_authenticator();
     bool start_query_services();
     bool start_heartbeat_services();
@@ -106,6 +171,18 @@ private:
     const configuration& configuration_;
 
     // These are thread safe.
+    dispatcher query_dispatch_;
+    status_monitor status_;
+    fee_histogram pool_fees_;
+    fee_estimator fee_estimates_;
+    address_index addresses_;
+    filter_index filters_;
+    header_index headers_;
+    mempool_index mempool_;
+    script_index scripts_;
+    merkle_cache merkle_trees_;
+    verdict_cache broadcasts_;
+    verdict_cache validations_;
     authenticator authenticator_;
     query_service secure_query_service_;
     query_service public_query_service_;
@@ -24,6 +24,7 @@
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/settings.hpp>
+#include <bitcoin/server/utility/relay_monitor.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -52,6 +53,9 @@ public:
     /// Stop the service.
     bool stop() override;
 
+    /// Relay traffic and subscription accounting.
+    const relay_monitor& monitor() const;
+
 protected:
     typedef bc::protocol::zmq::socket socket;
 
@@ -61,21 +65,32 @@ protected:
     // Implement the service.
     virtual void work() override;
 
+    // Relay a message in either direction (integrated worker).
+    void forward(socket& xsub, socket& xpub, bc::protocol::zmq::poller& poller);
+    void subscribe(socket& xpub, socket& xsub);
+
 private:
     bool handle_reorganization(const code& ec, size_t fork_height,
         block_const_ptr_list_const_ptr new_blocks,
         block_const_ptr_list_const_ptr old_blocks);
 
     void publish_blocks(uint32_t fork_height,
-        block_const_ptr_list_const_ptr blocks);
+        block_const_ptr_list_const_ptr blocks,
+        block_const_ptr_list_const_ptr old_blocks,
+        const asio::time_point& entry);
+    void publish_reorganization(socket& publisher, uint32_t fork_height,
+        block_const_ptr_list_const_ptr new_blocks,
+        block_const_ptr_list_const_ptr old_blocks,
+        const asio::time_point& entry);
     void publish_block(socket& publisher, uint32_t height,
-        block_const_ptr block);
+        block_const_ptr block, const asio::time_point& entry);
 
     const bool secure_;
     const bool verbose_;
     const server::settings& settings_;
 
     // These are thread safe.
+    relay_monitor monitor_;
     bc::protocol::zmq::authenticator& authenticator_;
     server_node& node_;
 };
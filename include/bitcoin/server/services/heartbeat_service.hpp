@@ -55,13 +55,21 @@ protected:
     void publish(uint32_t count, socket& socket);
 
 private:
+    // Serialize the chain tip and server load (extended heartbeat).
+    data_chunk status();
+
     const bool secure_;
     const bool verbose_;
     const server::settings& settings_;
     const int32_t period_;
 
-    // This is thread safe.
+    // These are protected by the worker thread.
+    uint64_t query_microseconds_;
+    asio::time_point sampled_;
+
+    // These are thread safe.
     bc::protocol::zmq::authenticator& authenticator_;
+    server_node& node_;
 };
 
 } // namespace server
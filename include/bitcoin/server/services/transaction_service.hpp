@@ -19,10 +19,14 @@
 #ifndef LIBBITCOIN_SERVER_TRANSACTION_SERVICE_HPP
 #define LIBBITCOIN_SERVER_TRANSACTION_SERVICE_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <vector>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/settings.hpp>
+#include <bitcoin/server/utility/relay_monitor.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -51,6 +55,9 @@ public:
     /// Stop the service.
     bool stop() override;
 
+    /// Relay traffic and subscription accounting.
+    const relay_monitor& monitor() const;
+
 protected:
     typedef bc::protocol::zmq::socket socket;
 
@@ -60,15 +67,35 @@ protected:
     // Implement the service.
     virtual void work() override;
 
+    // Relay a message in either direction (integrated worker).
+    void forward(socket& xsub, socket& xpub, bc::protocol::zmq::poller& poller);
+    void subscribe(socket& xpub, socket& xsub);
+
 private:
+    typedef std::vector<transaction_const_ptr> transaction_const_ptr_list;
+
     bool handle_transaction(const code& ec, transaction_const_ptr tx);
-    void publish_transaction(transaction_const_ptr tx);
+    void publish_transaction(transaction_const_ptr tx,
+        const asio::time_point& entry);
+    void publish_transactions(const transaction_const_ptr_list& batch,
+        const asio::time_point& entry);
+    void publish_expired();
+    void publish_remaining(socket& xpub);
+    int32_t remaining_window();
 
     const bool secure_;
     const bool verbose_;
     const server::settings& settings_;
+    const int32_t batch_window_;
+    const size_t batch_limit_;
+
+    // These are protected by batch mutex.
+    transaction_const_ptr_list batch_;
+    asio::time_point batch_opened_;
+    shared_mutex batch_mutex_;
 
     // These are thread safe.
+    relay_monitor monitor_;
     bc::protocol::zmq::authenticator& authenticator_;
     server_node& node_;
 };
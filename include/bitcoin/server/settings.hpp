@@ -44,8 +44,25 @@ public:
     uint32_t subscription_limit;
     uint32_t subscription_expiration_minutes;
     uint32_t heartbeat_interval_seconds;
+    bool extended_heartbeat;
     bool block_service_enabled;
+    bool publish_reorganizations;
     bool transaction_service_enabled;
+    uint32_t transaction_batch_milliseconds;
+    uint32_t transaction_batch_size;
+    bool address_index_enabled;
+    bool filter_index_enabled;
+    bool header_index_enabled;
+    bool mempool_index_enabled;
+    uint32_t unconfirmed_expiration_hours;
+    bool script_index_enabled;
+    bool fee_estimator_enabled;
+    uint32_t fee_estimator_save_blocks;
+    uint32_t merkle_cache_blocks;
+    uint32_t broadcast_cache_seconds;
+    uint32_t broadcast_cache_entries;
+    uint32_t validation_cache_seconds;
+    uint32_t validation_cache_entries;
 
     config::endpoint public_query_endpoint;
     config::endpoint public_heartbeat_endpoint;
@@ -64,6 +81,9 @@ public:
     /// Helpers.
     asio::duration heartbeat_interval() const;
     asio::duration subscription_expiration() const;
+    asio::duration broadcast_cache_lifetime() const;
+    asio::duration validation_cache_lifetime() const;
+    asio::duration unconfirmed_expiration() const;
 };
 
 } // namespace server
@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_ACCOUNT_SCANNER_HPP
+#define LIBBITCOIN_SERVER_ACCOUNT_SCANNER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+class server_node;
+
+// This class is thread safe.
+// Discover the used addresses of an extended public key. The chains are
+// scanned in turn, each in windows of gap limit addresses, derived and probed
+// against the history index concurrently, until a window contains no used
+// address. So at most one window of probes is in flight per scan.
+class BCS_API account_scanner
+  : public std::enable_shared_from_this<account_scanner>
+{
+public:
+    typedef std::shared_ptr<account_scanner> ptr;
+
+    struct used_address
+    {
+        uint32_t chain;
+        uint32_t index;
+        short_hash hash;
+        chain::history_compact::list history;
+    };
+
+    typedef std::vector<used_address> list;
+    typedef std::function<void(const code&, const list&)> scan_handler;
+
+    /// Construct a scanner for the account key.
+    account_scanner(server_node& node, const wallet::hd_public& key,
+        uint8_t version, uint32_t gap_limit, size_t from_height);
+
+    /// This class is not copyable.
+    account_scanner(const account_scanner&) = delete;
+    void operator=(const account_scanner&) = delete;
+
+    /// Scan the chains, used addresses are ordered by chain and index.
+    void start(const std::vector<uint32_t>& chains, scan_handler handler);
+
+protected:
+    typedef std::function<void(const code&,
+        const chain::history_compact::list&)> history_handler;
+
+    /// Fetch the confirmed history of the address from the from height.
+    virtual void fetch_history(const wallet::payment_address& address,
+        history_handler handler);
+
+private:
+    typedef std::shared_ptr<list> list_ptr;
+    typedef std::vector<uint32_t> chain_list;
+
+    void scan_chain(const chain_list& chains, size_t position,
+        scan_handler handler);
+    void handle_chain(const code& ec, const chain_list& chains,
+        size_t position, scan_handler handler);
+
+    void scan(const wallet::hd_public& chain_key, uint32_t chain,
+        uint32_t first, result_handler complete);
+    void probe(const wallet::hd_public& chain_key, uint32_t chain,
+        uint32_t index, list_ptr window, size_t slot,
+        result_handler complete);
+
+    void handle_history(const code& ec,
+        const chain::history_compact::list& history, list_ptr window,
+        size_t slot, result_handler complete);
+    void handle_window(const code& ec, const wallet::hd_public& chain_key,
+        uint32_t chain, uint32_t first, list_ptr window,
+        result_handler complete);
+    void handle_complete(const code& ec, scan_handler handler);
+
+    // These are thread safe.
+    server_node& node_;
+    const wallet::hd_public key_;
+    const uint8_t version_;
+    const uint32_t gap_limit_;
+    const size_t from_height_;
+    dispatcher dispatch_;
+
+    // This is protected by mutex.
+    list used_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_BLOCK_FILTER_HPP
+#define LIBBITCOIN_SERVER_BLOCK_FILTER_HPP
+
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+// This class is thread safe.
+// The BIP158 basic block filter, a Golomb-Rice coded set of the siphash of
+// each output script of the block and of each script spent by the block.
+// Empty scripts and null data output scripts are not included.
+class BCS_API block_filter
+{
+public:
+    /// The Golomb-Rice coding parameter.
+    static BC_CONSTEXPR uint8_t rice_bits = 19;
+
+    /// The inverse of the false positive rate.
+    static BC_CONSTEXPR uint64_t rice_modulus = 784931;
+
+    /// The filter of the block given the scripts of its spent outputs.
+    static data_chunk compute(const chain::block& block,
+        const data_stack& prevout_scripts);
+
+    /// The filter header, committing to the filter and the previous header.
+    static hash_digest header(const data_chunk& filter,
+        const hash_digest& previous_header);
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
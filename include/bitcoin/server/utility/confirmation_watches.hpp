@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_CONFIRMATION_WATCHES_HPP
+#define LIBBITCOIN_SERVER_CONFIRMATION_WATCHES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/route.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+// This class is thread safe.
+// Watches of the confirmation depths of transactions. A watch begins
+// unconfirmed and is confirmed by block or by locating a transaction that
+// was confirmed before subscription. Confirmed watches are ordered by the
+// height at which the next requested depth is reached, so each block visits
+// only those that fire. A watch is dropped once all its depths are reached.
+class BCS_API confirmation_watches
+{
+public:
+    struct watch
+    {
+        route reply_to;
+        uint32_t id;
+        hash_digest tx_hash;
+        std::vector<uint32_t> depths;
+        asio::time_point expires;
+
+        // The index of the next depth and the height of confirmation.
+        size_t next;
+        size_t height;
+    };
+
+    /// A depth of zero signals that the confirmation was reorganized out.
+    struct update
+    {
+        route reply_to;
+        uint32_t id;
+        code ec;
+        hash_digest tx_hash;
+        uint32_t depth;
+        uint32_t height;
+    };
+
+    typedef std::shared_ptr<watch> watch_ptr;
+    typedef std::vector<update> update_list;
+
+    /// Construct an empty set of watches.
+    confirmation_watches();
+
+    /// This class is not copyable.
+    confirmation_watches(const confirmation_watches&) = delete;
+    void operator=(const confirmation_watches&) = delete;
+
+    /// The number of watches.
+    size_t size() const;
+
+    /// Add an unconfirmed watch, replacing that of the route and transaction.
+    /// Returns false, having removed any replaced watch, if at the limit.
+    bool subscribe(watch_ptr watch, size_t limit);
+
+    /// Remove the watch of the route and transaction, if any.
+    void unsubscribe(const route& reply_to, const hash_digest& tx_hash);
+
+    /// Confirm the watch at the height, if it remains unconfirmed.
+    void locate(watch_ptr watch, size_t height, size_t top_height,
+        update_list& out);
+
+    /// Reset watches confirmed above the fork point and confirm watches of
+    /// the transactions of the new blocks, which are above the fork point.
+    void reorganize(size_t fork_height,
+        const block_const_ptr_list& new_blocks, update_list& out);
+
+    /// Remove watches expired at the time, with a channel timeout update.
+    void purge(const asio::time_point& now, update_list& out);
+
+private:
+    typedef std::unordered_multimap<hash_digest, watch_ptr> unconfirmed_map;
+    typedef std::multimap<size_t, watch_ptr> confirmed_map;
+
+    // These require the exclusive mutex.
+    void confirm(watch_ptr watch, size_t height);
+    void reached(size_t top_height, update_list& out);
+    void remove(const route& reply_to, const hash_digest& tx_hash);
+
+    // These are protected by mutex.
+    unconfirmed_map unconfirmed_;
+    confirmed_map confirmed_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_FEE_ESTIMATOR_HPP
+#define LIBBITCOIN_SERVER_FEE_ESTIMATOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/configuration.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/utility/fee_histogram.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+class server_node;
+
+// This class is thread safe.
+// Estimate fee rates from the confirmation delay of pool transactions, by
+// fee histogram bucket. Each block decays the statistics and records the
+// delay of the tracked transactions it confirms. A transaction that remains
+// unconfirmed beyond the maximum target is recorded as a failure. The
+// statistics are saved to a file in the database directory at a block
+// interval and on stop, each save replacing the file by rename.
+class BCS_API fee_estimator
+{
+public:
+    /// The greatest confirmation target (in blocks).
+    static BC_CONSTEXPR size_t max_target = 25;
+
+    /// Construct a fee estimator.
+    fee_estimator(server_node& node, const configuration& configuration);
+
+    /// This class is not copyable.
+    fee_estimator(const fee_estimator&) = delete;
+    void operator=(const fee_estimator&) = delete;
+
+    /// True if the estimator is enabled.
+    bool enabled() const;
+
+    /// Restore statistics and subscribe to pool and chain notifications.
+    bool start();
+
+    /// Save the statistics if started and saving is enabled.
+    bool stop();
+
+    /// The lowest bucket fee rate expected to confirm within the target.
+    /// Returns false if no bucket has sufficient confirmations.
+    bool estimate(size_t target, uint64_t& rate) const;
+
+    /// Restore the statistics from the file.
+    /// Returns false if there is none or it is of other dimensions.
+    bool load();
+
+    /// Replace the file with the statistics, false on failure.
+    bool save() const;
+
+    /// Track the pooled transaction from the top height until confirmed.
+    void add(const hash_digest& tx_hash, uint64_t rate);
+
+    /// Record the delays of the blocks above the fork height.
+    void reorganize(size_t fork_height, const block_const_ptr_list& blocks);
+
+private:
+    struct bucket_stats
+    {
+        double total;
+        std::array<double, max_target> confirmed;
+    };
+
+    struct entry
+    {
+        size_t bucket;
+        size_t height;
+    };
+
+    typedef std::array<bucket_stats, fee_histogram::buckets> stats;
+    typedef std::unordered_map<hash_digest, entry> entry_map;
+    typedef std::map<size_t, std::vector<hash_digest>> height_map;
+
+    bool write(const stats& copy) const;
+    void connect(const chain::block& block, size_t height);
+    void expire(size_t height);
+
+    void handle_last_height(const code& ec, size_t height);
+    bool handle_reorganization(const code& ec, size_t fork_height,
+        block_const_ptr_list_const_ptr new_blocks,
+        block_const_ptr_list_const_ptr old_blocks);
+    bool handle_transaction(const code& ec, transaction_const_ptr tx);
+
+    // These are thread safe.
+    server_node& node_;
+    const bool enabled_;
+    const size_t save_interval_;
+    const boost::filesystem::path path_;
+
+    // These are protected by mutex.
+    stats stats_;
+    entry_map entries_;
+    height_map heights_;
+    size_t top_height_;
+    size_t unsaved_;
+    bool started_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_FEE_HISTOGRAM_HPP
+#define LIBBITCOIN_SERVER_FEE_HISTOGRAM_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+class server_node;
+
+// This class is thread safe.
+// Accumulate the transactions of the pool into fee rate buckets, each with
+// a lower bound in satoshis per byte. Transactions are added as accepted to
+// the pool and removed as confirmed, each by a search of the bucket bounds.
+// The pool may drop a transaction without notice, so each is also removed
+// once older than the lifetime, checked on each block.
+class BCS_API fee_histogram
+{
+public:
+    static BC_CONSTEXPR size_t buckets = 32;
+
+    /// The lower fee rate bound of each bucket (satoshis per byte).
+    static const std::array<uint32_t, buckets> bounds;
+
+    /// The fee rate of a validated transaction (satoshis per byte).
+    static uint64_t fee_rate(const chain::transaction& tx);
+
+    /// The bucket of the fee rate, the last with a bound not above it.
+    static size_t bucket_index(uint64_t rate);
+
+    /// Construct an empty fee histogram.
+    fee_histogram(server_node& node, const asio::duration& lifetime);
+
+    /// This class is not copyable.
+    fee_histogram(const fee_histogram&) = delete;
+    void operator=(const fee_histogram&) = delete;
+
+    /// Subscribe to pool acceptances and chain reorganizations.
+    bool start();
+
+    /// [ buckets:1 ][[ rate:4 ][ transactions:4 ][ bytes:8 ]...]
+    data_chunk to_data() const;
+
+    /// Count the pooled transaction until removed or expired.
+    void add(const hash_digest& tx_hash, uint64_t rate, uint64_t bytes,
+        const asio::time_point& expiry);
+
+    /// Stop counting the transaction, if counted.
+    void remove(const hash_digest& tx_hash);
+
+    /// Stop counting the transactions expired at the time.
+    void purge(const asio::time_point& now);
+
+private:
+    struct bucket
+    {
+        uint32_t transactions;
+        uint64_t bytes;
+    };
+
+    struct entry
+    {
+        size_t bucket;
+        uint64_t bytes;
+        asio::time_point expiry;
+    };
+
+    typedef std::unordered_map<hash_digest, entry> entry_map;
+    typedef std::deque<std::pair<hash_digest, asio::time_point>> entry_queue;
+
+    // These require the exclusive mutex.
+    void erase(entry_map::iterator it);
+
+    bool handle_reorganization(const code& ec, size_t fork_height,
+        block_const_ptr_list_const_ptr new_blocks,
+        block_const_ptr_list_const_ptr old_blocks);
+    bool handle_transaction(const code& ec, transaction_const_ptr tx);
+
+    // These are thread safe.
+    server_node& node_;
+    const asio::duration lifetime_;
+
+    // These are protected by mutex (queue is oldest first).
+    std::array<bucket, buckets> buckets_;
+    entry_map entries_;
+    entry_queue queue_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -33,6 +33,9 @@ static BC_CONSTEXPR size_t code_size = sizeof(uint32_t);
 static BC_CONSTEXPR size_t index_size = sizeof(uint32_t);
 static BC_CONSTEXPR size_t point_size = hash_size + sizeof(uint32_t);
 
+// The maximum number of items in a batch query.
+static BC_CONSTEXPR size_t query_batch_limit = 1000;
+
 // fetch_history stuff
 
 bool BCS_API unwrap_fetch_history_args(wallet::payment_address& address,
@@ -51,6 +54,14 @@ void BCS_API transaction_fetched(const code& ec, transaction_ptr tx,
     size_t height, size_t position, const message& request,
     send_handler handler);
 
+// fetch_transactions stuff
+
+bool BCS_API unwrap_fetch_transactions_args(hash_list& hashes,
+    const message& request);
+
+void BCS_API fetch_transaction_list(server_node& node, const hash_list& hashes,
+    bool require_confirmed, const message& request, send_handler handler);
+
 } // namespace server
 } // namespace libbitcoin
 
@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_HISTOGRAM_HPP
+#define LIBBITCOIN_SERVER_HISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+// This class is thread safe.
+// Accumulate durations into base two logarithmic buckets of microseconds.
+// Bucket zero counts durations under one microsecond, bucket n (n > 0) counts
+// durations of at least 2^(n-1) and less than 2^n microseconds, and the last
+// bucket also counts all longer durations.
+class BCS_API histogram
+{
+public:
+    static BC_CONSTEXPR size_t buckets = 32;
+
+    /// Construct an empty histogram.
+    histogram();
+
+    /// This class is not copyable.
+    histogram(const histogram&) = delete;
+    void operator=(const histogram&) = delete;
+
+    /// Record one duration.
+    void record(const asio::duration& elapsed);
+
+    /// The number of recorded durations.
+    uint64_t count() const;
+
+    /// The sum of recorded durations in microseconds.
+    uint64_t total() const;
+
+    /// The number of recorded durations in the bucket.
+    uint64_t bucket(size_t index) const;
+
+    /// [ buckets:1 ][ count:8 ][ total:8 ][[ bucket:8 ]...]
+    data_chunk to_data() const;
+
+private:
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> total_;
+    std::array<std::atomic<uint64_t>, buckets> buckets_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
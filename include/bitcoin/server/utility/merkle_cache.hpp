@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_MERKLE_CACHE_HPP
+#define LIBBITCOIN_SERVER_MERKLE_CACHE_HPP
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+class server_node;
+
+// This class is thread safe.
+// A least recently used cache of block merkle trees, keyed by block hash, so
+// that a tree stored after its block is reorganized out is never matched.
+// Trees of blocks reorganized out are dropped upon reorganization.
+class BCS_API merkle_cache
+{
+public:
+    /// All levels of a merkle tree, from the transaction hashes to the root.
+    typedef std::vector<hash_list> tree;
+    typedef std::shared_ptr<const tree> tree_ptr;
+
+    /// Build the merkle tree of the transaction hashes of a block.
+    static tree_ptr build(const hash_list& hashes);
+
+    /// The merkle branch of the leaf at the position, from the leaf up.
+    static hash_list branch(const tree& tree, size_t position);
+
+    /// Construct a merkle cache.
+    merkle_cache(server_node& node, size_t capacity);
+
+    /// This class is not copyable.
+    merkle_cache(const merkle_cache&) = delete;
+    void operator=(const merkle_cache&) = delete;
+
+    /// Subscribe to chain reorganizations.
+    bool start();
+
+    /// The cached tree of the block, or nullptr.
+    tree_ptr find(const hash_digest& block_hash);
+
+    /// Cache the tree of the block.
+    void store(const hash_digest& block_hash, tree_ptr tree);
+
+private:
+    typedef std::list<std::pair<hash_digest, tree_ptr>> entry_list;
+    typedef std::unordered_map<hash_digest, entry_list::iterator> entry_map;
+
+    bool handle_reorganization(const code& ec, size_t fork_height,
+        block_const_ptr_list_const_ptr new_blocks,
+        block_const_ptr_list_const_ptr old_blocks);
+
+    // These are thread safe.
+    server_node& node_;
+    const size_t capacity_;
+
+    // These are protected by mutex (most recently used first).
+    entry_list entries_;
+    entry_map index_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
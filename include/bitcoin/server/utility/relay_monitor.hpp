@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_RELAY_MONITOR_HPP
+#define LIBBITCOIN_SERVER_RELAY_MONITOR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/protocol.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/utility/histogram.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+// This class is thread safe.
+// Relay pub-sub traffic while accounting for messages and subscriptions.
+// Forwarding and subscription must be invoked from the relaying thread only.
+// Worker messages carry a trailing timing frame, which is not relayed.
+// The subscriber socket drops silently at its high water mark, so drops and
+// subscriber queue depth are not observable here. The backlog is that of
+// worker messages awaiting the relay.
+class BCS_API relay_monitor
+{
+public:
+    /// Construct a relay monitor.
+    relay_monitor();
+
+    /// This class is not copyable.
+    relay_monitor(const relay_monitor&) = delete;
+    void operator=(const relay_monitor&) = delete;
+
+    /// Append the timing frame to a worker message, recording serialization.
+    void stamp(bc::protocol::zmq::message& message,
+        const asio::time_point& entry);
+
+    /// Append the timing frame to a worker message whose serialization began
+    /// after entry, such as a batch, recording serialization from its start.
+    void stamp(bc::protocol::zmq::message& message,
+        const asio::time_point& entry, const asio::time_point& serializing);
+
+    /// Relay one message from the workers (xsub) to subscribers (xpub).
+    code forward(bc::protocol::zmq::socket& xsub,
+        bc::protocol::zmq::socket& xpub);
+
+    /// Relay one subscription frame from subscribers (xpub) to workers (xsub).
+    code subscribe(bc::protocol::zmq::socket& xpub,
+        bc::protocol::zmq::socket& xsub);
+
+    /// Record the worker backlog observed upon completion of a forward.
+    void backlog(bool pending);
+
+    /// Messages and bytes relayed to subscribers.
+    uint64_t forwarded_messages() const;
+    uint64_t forwarded_bytes() const;
+
+    /// The number of topic subscriptions currently held by subscribers.
+    uint32_t subscriptions() const;
+
+    /// Forwards that found a worker message queued, in the current and
+    /// longest runs.
+    uint32_t worker_backlog() const;
+    uint32_t peak_worker_backlog() const;
+
+    /// From notification, or the start of batch serialization, to a
+    /// serialized worker message.
+    const histogram& serialization() const;
+
+    /// From a serialized worker message to its receipt by the relay.
+    const histogram& handoff() const;
+
+    /// From receipt by the relay to acceptance by the subscriber socket.
+    const histogram& send() const;
+
+    /// From notification to acceptance by the subscriber socket.
+    const histogram& latency() const;
+
+private:
+    std::atomic<uint64_t> forwarded_messages_;
+    std::atomic<uint64_t> forwarded_bytes_;
+    std::atomic<uint32_t> subscriptions_;
+    std::atomic<uint32_t> worker_backlog_;
+    std::atomic<uint32_t> peak_worker_backlog_;
+    histogram serialization_;
+    histogram handoff_;
+    histogram send_;
+    histogram latency_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_STATUS_MONITOR_HPP
+#define LIBBITCOIN_SERVER_STATUS_MONITOR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+class server_node;
+
+// This class is thread safe.
+// Track the chain tip, pool size and query load for status reporting. The
+// pool is approximated by the transactions accepted since start and not yet
+// confirmed or expired. It omits those pooled before start and may retain
+// those conflicted or evicted until expiry, so it is not used to decide the
+// validity of a query.
+class BCS_API status_monitor
+{
+public:
+    /// A pool transaction and its position in the order of pool acceptance.
+    struct pool_entry
+    {
+        hash_digest hash;
+        uint32_t size;
+        uint64_t sequence;
+    };
+
+    typedef std::vector<pool_entry> pool_list;
+
+    /// Construct a status monitor, pool entries expire after the lifetime.
+    status_monitor(server_node& node, const asio::duration& lifetime);
+
+    /// This class is not copyable.
+    status_monitor(const status_monitor&) = delete;
+    void operator=(const status_monitor&) = delete;
+
+    /// Subscribe to chain and pool notifications and seed the chain tip.
+    bool start();
+
+    /// The height and hash of the top block of the chain.
+    void top(size_t& height, hash_digest& hash) const;
+
+    /// The number of pool transactions observed and not yet confirmed.
+    size_t pool_size() const;
+
+    /// The pool transactions accepted after the sequence, in acceptance
+    /// order, returning the sequence of the last acceptance observed.
+    uint64_t pool(uint64_t from_sequence, pool_list& out) const;
+
+    /// The number of queries dispatched and not yet answered.
+    size_t queries() const;
+
+    /// The cumulative time spent answering queries (microseconds).
+    uint64_t query_microseconds() const;
+
+    /// Record the dispatch of a query.
+    void begin_query();
+
+    /// Record the answer to a query dispatched at the given time.
+    void end_query(const asio::time_point& started);
+
+private:
+    struct pool_row
+    {
+        uint32_t size;
+        uint64_t sequence;
+        asio::time_point expires;
+    };
+
+    typedef std::unordered_map<hash_digest, pool_row> pool_map;
+
+    void handle_last_height(const code& ec, size_t height);
+    void handle_header(const code& ec, header_const_ptr header,
+        size_t height);
+    bool handle_reorganization(const code& ec, size_t fork_height,
+        block_const_ptr_list_const_ptr new_blocks,
+        block_const_ptr_list_const_ptr old_blocks);
+    bool handle_transaction(const code& ec, transaction_const_ptr tx);
+
+    // These are thread safe.
+    server_node& node_;
+    const asio::duration lifetime_;
+    std::atomic<size_t> queries_;
+    std::atomic<uint64_t> query_microseconds_;
+
+    // These are protected by mutex.
+    bool seeded_;
+    size_t top_height_;
+    hash_digest top_hash_;
+    uint64_t pool_sequence_;
+    pool_map pool_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
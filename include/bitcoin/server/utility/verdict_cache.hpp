@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_VERDICT_CACHE_HPP
+#define LIBBITCOIN_SERVER_VERDICT_CACHE_HPP
+
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+class server_node;
+
+// This class is thread safe.
+// A bounded cache of verdicts by hash, each retained for a lifetime. When
+// full the oldest entry is evicted. All entries are dropped on chain
+// reorganization, as verdicts may depend upon the chain. The payload hash is
+// used in place of an object hash, as a block header hash does not commit to
+// a malleated transaction list. A verdict that depends upon the chain is also
+// keyed by the chain top, as it may be stored after the cache is cleared.
+// Callers store only success, as a failure such as a missing previous output
+// may be resolved by a later transaction.
+class BCS_API verdict_cache
+{
+public:
+    /// Construct a verdict cache, a zero lifetime disables the cache.
+    verdict_cache(server_node& node, size_t capacity,
+        const asio::duration& lifetime);
+
+    /// This class is not copyable.
+    verdict_cache(const verdict_cache&) = delete;
+    void operator=(const verdict_cache&) = delete;
+
+    /// Subscribe to chain reorganizations.
+    bool start();
+
+    /// True if the cache is enabled.
+    bool enabled() const;
+
+    /// Set the unexpired verdict of the key, false if not found.
+    bool find(const hash_digest& key, code& verdict) const;
+
+    /// Cache the verdict of the key.
+    void store(const hash_digest& key, const code& verdict);
+
+private:
+    typedef std::pair<code, asio::time_point> entry;
+    typedef std::unordered_map<hash_digest, entry> entry_map;
+    typedef std::deque<std::pair<hash_digest, asio::time_point>> entry_queue;
+
+    bool handle_reorganization(const code& ec, size_t fork_height,
+        block_const_ptr_list_const_ptr new_blocks,
+        block_const_ptr_list_const_ptr old_blocks);
+
+    // These are thread safe.
+    server_node& node_;
+    const size_t capacity_;
+    const asio::duration lifetime_;
+
+    // These are protected by mutex (queue is oldest first).
+    entry_map entries_;
+    entry_queue queue_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -19,14 +19,19 @@
 #ifndef LIBBITCOIN_SERVER_NOTIFICATION_WORKER_HPP
 #define LIBBITCOIN_SERVER_NOTIFICATION_WORKER_HPP
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/messages/route.hpp>
 #include <bitcoin/server/settings.hpp>
 #include <bitcoin/server/utility/address_key.hpp>
+#include <bitcoin/server/utility/confirmation_watches.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -34,7 +39,8 @@ namespace server {
 class server_node;
 
 // This class is thread safe.
-// Provide address and stealth notifications to the query service.
+// Provide address, stealth, script and confirmation notifications to the query
+// service.
 class BCS_API notification_worker
   : public bc::protocol::zmq::worker
 {
@@ -55,6 +61,15 @@ public:
     virtual code subscribe_address(const route& reply_to, uint32_t id,
         const binary& prefix_filter, bool unsubscribe);
 
+    /// Subscribe to notifications of outputs to and spends of a script hash.
+    virtual code subscribe_script(const route& reply_to, uint32_t id,
+        const hash_digest& script_hash, bool unsubscribe);
+
+    /// Subscribe to confirmation depth notifications of a transaction.
+    virtual code subscribe_confirmations(const route& reply_to, uint32_t id,
+        const hash_digest& tx_hash, const std::vector<uint32_t>& depths,
+        bool unsubscribe);
+
 protected:
     typedef bc::protocol::zmq::socket socket;
 
@@ -69,6 +84,10 @@ private:
     typedef notifier<address_key, const code&, const binary&, uint32_t,
         const hash_digest&, transaction_const_ptr> address_subscriber;
 
+    typedef confirmation_watches::watch_ptr watch_ptr;
+    typedef confirmation_watches::update_list update_list;
+    typedef std::unordered_map<address_key, asio::time_point> script_map;
+
     // Remove expired subscriptions.
     void purge();
     int32_t purge_interval_milliseconds() const;
@@ -84,6 +103,19 @@ private:
 
     void notify_address(const binary& field, uint32_t height,
         const hash_digest& block_hash, transaction_const_ptr tx);
+    void notify_script(const chain::script& script, uint32_t height,
+        const hash_digest& block_hash, transaction_const_ptr tx);
+    void notify_spend(const chain::output_point& prevout, uint32_t height,
+        const hash_digest& block_hash, transaction_const_ptr tx);
+    void handle_spend(const code& ec, transaction_const_ptr parent,
+        uint32_t index, uint32_t height, const hash_digest& block_hash,
+        transaction_const_ptr tx);
+    bool scripted() const;
+
+    void notify_confirmations(size_t fork_height,
+        block_const_ptr_list_const_ptr new_blocks);
+    void handle_position(const code& ec, size_t height, watch_ptr watch);
+    void send_confirmations(const update_list& updates);
 
     // Send a notification to the subscriber.
     void send(const route& reply_to, const std::string& command,
@@ -92,7 +124,7 @@ private:
     bool handle_address(const code& ec, const binary& field, uint32_t height,
         const hash_digest& block_hash, transaction_const_ptr tx,
         const route& reply_to, uint32_t id, const binary& prefix_filter,
-        sequence_ptr sequence);
+        const std::string& command, sequence_ptr sequence);
 
     const bool secure_;
     const server::settings& settings_;
@@ -101,6 +133,13 @@ private:
     server_node& node_;
     bc::protocol::zmq::authenticator& authenticator_;
     address_subscriber::ptr address_subscriber_;
+    address_subscriber::ptr script_subscriber_;
+    confirmation_watches confirmations_;
+
+    // The script subscriptions (or a superset), so that outputs are hashed
+    // only when there is a subscription. This is protected by script mutex.
+    script_map scripts_;
+    mutable shared_mutex script_mutex_;
 };
 
 } // namespace server
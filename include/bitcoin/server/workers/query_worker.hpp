@@ -22,6 +22,7 @@
 #include <memory>
 #include <functional>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
@@ -58,6 +59,9 @@ protected:
     virtual bool disconnect(socket& router);
     virtual void query(socket& router);
 
+    // Send a response completed off the worker thread.
+    virtual code send(message& response);
+
     // Implement the worker.
     virtual void work();
 
@@ -70,6 +74,9 @@ private:
     server_node& node_;
     bc::protocol::zmq::authenticator& authenticator_;
 
+    // This is set by the worker thread before any query is received.
+    std::thread::id thread_;
+
     // This is protected by base class mutex.
     command_map command_handlers_;
 };
@@ -0,0 +1,377 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/indexes/address_index.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/configuration.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/server_node.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+#define NAME "address_index"
+
+using namespace std::placeholders;
+using namespace bc::chain;
+
+address_index::address_index(server_node& node,
+    const configuration& configuration)
+  : chain_index(node, configuration, NAME)
+{
+}
+
+// Properties.
+// ----------------------------------------------------------------------------
+
+bool address_index::balance(const short_hash& hash, size_t& height,
+    uint64_t& received, uint64_t& spent) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    if (!indexed_top(height))
+        return false;
+
+    const auto it = totals_.find(hash);
+    received = it == totals_.end() ? 0 : it->second.received;
+    spent = it == totals_.end() ? 0 : it->second.spent;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool address_index::unspent(const short_hash& hash, size_t& height,
+    unspent_list& outputs) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    if (!indexed_top(height))
+        return false;
+
+    const auto it = unspent_.find(hash);
+
+    if (it == unspent_.end())
+        return true;
+
+    outputs.reserve(it->second.size());
+
+    for (const auto& row: it->second)
+        outputs.push_back(
+        {
+            output_point(row.first.first, row.first.second),
+            row.second.value,
+            row.second.height
+        });
+
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Prepare.
+// ----------------------------------------------------------------------------
+
+// Resolve the address and value of each output spent by the block.
+void address_index::prepare(block_const_ptr block, size_t height,
+    result_handler handler)
+{
+    typedef std::pair<output_point, size_t> remote_point;
+
+    const auto& txs = block->transactions();
+    std::unordered_map<hash_digest, const transaction*> local;
+    size_t inputs = 0;
+
+    for (const auto& tx: txs)
+    {
+        local.emplace(tx.hash(), &tx);
+        inputs += tx.is_coinbase() ? 0 : tx.inputs().size();
+    }
+
+    const auto spends = std::make_shared<std::vector<spend>>(inputs,
+        spend{ null_short_hash, { null_hash, 0 }, { 0, 0 } });
+
+    std::vector<remote_point> remote;
+    size_t slot = 0;
+
+    for (const auto& tx: txs)
+    {
+        if (tx.is_coinbase())
+            continue;
+
+        for (const auto& input: tx.inputs())
+        {
+            const auto& prevout = input.previous_output();
+            const auto it = local.find(prevout.hash());
+
+            // Outputs created within the block are resolved from the block.
+            if (it == local.end())
+                remote.push_back({ prevout, slot });
+            else if (prevout.index() < it->second->outputs().size())
+            {
+                const auto& output = it->second->outputs()[prevout.index()];
+                const auto address = output.address();
+
+                if (address)
+                    (*spends)[slot] = spend
+                    {
+                        address.hash(),
+                        { prevout.hash(), prevout.index() },
+                        { output.value(), height }
+                    };
+            }
+
+            ++slot;
+        }
+    }
+
+    if (remote.empty())
+    {
+        handle_prepared(error::success, block, height, spends, handler);
+        return;
+    }
+
+    const auto complete = synchronize(
+        std::bind(&address_index::handle_prepared,
+            this, _1, block, height, spends, handler),
+        remote.size(), NAME "_prepare");
+
+    for (const auto& point: remote)
+        node_.chain().fetch_transaction(point.first.hash(), true,
+            std::bind(&address_index::handle_prevout,
+                this, _1, _2, _3, point.first, point.second, spends,
+                    complete));
+}
+
+void address_index::handle_prevout(const code& ec, transaction_const_ptr tx,
+    size_t tx_height, const output_point& prevout, size_t slot,
+    spends_ptr spends, result_handler complete)
+{
+    if (ec)
+    {
+        complete(ec);
+        return;
+    }
+
+    // Outputs below the start height were never counted as received.
+    if (tx_height >= start_height_ && prevout.index() < tx->outputs().size())
+    {
+        const auto& output = tx->outputs()[prevout.index()];
+        const auto address = output.address();
+
+        // Each lookup writes a distinct element of the preallocated list.
+        if (address)
+            (*spends)[slot] = spend
+            {
+                address.hash(),
+                { prevout.hash(), prevout.index() },
+                { output.value(), tx_height }
+            };
+    }
+
+    complete(error::success);
+}
+
+void address_index::handle_prepared(const code& ec, block_const_ptr block,
+    size_t height, spends_ptr spends, result_handler handler)
+{
+    if (ec)
+    {
+        handler(ec);
+        return;
+    }
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    prepared_mutex_.lock();
+    prepared_[height] = prepared{ block->header().hash(), std::move(*spends) };
+    prepared_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    handler(error::success);
+}
+
+// Connect/Disconnect.
+// ----------------------------------------------------------------------------
+
+bool address_index::connect(block_const_ptr block, size_t height)
+{
+    prepared entry;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    prepared_mutex_.lock();
+
+    const auto it = prepared_.find(height);
+    const auto found = it != prepared_.end() &&
+        it->second.block_hash == block->header().hash();
+
+    if (found)
+    {
+        entry = std::move(it->second);
+
+        // Preparations at or below this height are obsolete.
+        prepared_.erase(prepared_.begin(), std::next(it));
+    }
+
+    prepared_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (!found)
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "The " NAME " is missing block " << height << " preparation.";
+        return false;
+    }
+
+    // Aggregate the block by address, which is retained for disconnection.
+    undo record;
+
+    // Outputs are added before spends are removed, as spends may be local.
+    for (const auto& tx: block->transactions())
+    {
+        const auto tx_hash = tx.hash();
+        const auto& outputs = tx.outputs();
+
+        for (uint32_t index = 0; index < outputs.size(); ++index)
+        {
+            const auto& output = outputs[index];
+            const auto address = output.address();
+
+            if (!address)
+                continue;
+
+            const auto address_hash = address.hash();
+            record.totals[address_hash].received += output.value();
+            unspent_[address_hash][point_key(tx_hash, index)] =
+                output_row{ output.value(), height };
+        }
+    }
+
+    for (const auto& spent: entry.spends)
+    {
+        if (spent.hash == null_short_hash)
+            continue;
+
+        record.totals[spent.hash].spent += spent.output.value;
+        const auto outputs = unspent_.find(spent.hash);
+
+        if (outputs != unspent_.end())
+        {
+            outputs->second.erase(spent.point);
+
+            if (outputs->second.empty())
+                unspent_.erase(outputs);
+        }
+
+        record.spends.push_back(spent);
+    }
+
+    for (const auto& row: record.totals)
+    {
+        auto& total = totals_[row.first];
+        total.received += row.second.received;
+        total.spent += row.second.spent;
+    }
+
+    undo_.push_back(std::move(record));
+
+    if (undo_.size() > depth_)
+        undo_.pop_front();
+
+    return true;
+}
+
+// Spends are restored before outputs are removed, the reverse of connect.
+bool address_index::disconnect(block_const_ptr block, size_t)
+{
+    if (undo_.empty())
+        return false;
+
+    const auto& record = undo_.back();
+
+    for (const auto& spent: record.spends)
+        unspent_[spent.hash][spent.point] = spent.output;
+
+    for (const auto& tx: block->transactions())
+    {
+        const auto tx_hash = tx.hash();
+        const auto& outputs = tx.outputs();
+
+        for (uint32_t index = 0; index < outputs.size(); ++index)
+        {
+            const auto address = outputs[index].address();
+
+            if (!address)
+                continue;
+
+            const auto it = unspent_.find(address.hash());
+
+            if (it == unspent_.end())
+                continue;
+
+            it->second.erase(point_key(tx_hash, index));
+
+            if (it->second.empty())
+                unspent_.erase(it);
+        }
+    }
+
+    for (const auto& row: record.totals)
+    {
+        const auto it = totals_.find(row.first);
+        BITCOIN_ASSERT(it != totals_.end());
+
+        auto& total = it->second;
+        total.received -= row.second.received;
+        total.spent -= row.second.spent;
+
+        if (total.received == 0 && total.spent == 0)
+            totals_.erase(it);
+    }
+
+    undo_.pop_back();
+    return true;
+}
+
+void address_index::reset()
+{
+    totals_.clear();
+    unspent_.clear();
+    undo_.clear();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    prepared_mutex_.lock();
+    prepared_.clear();
+    prepared_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace server
+} // namespace libbitcoin
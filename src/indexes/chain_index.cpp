@@ -0,0 +1,487 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/indexes/chain_index.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/configuration.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/server_node.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace std::placeholders;
+
+// The number of blocks fetched and prepared concurrently during a scan.
+static constexpr size_t block_window_size = 16;
+
+// The number of headers fetched concurrently during a headers only scan.
+static constexpr size_t header_window_size = 500;
+
+// Undo depth when reorganization is unlimited, deeper reorganizations rebuild.
+static constexpr size_t default_depth = 256;
+
+// Log progress of long scans at this height interval.
+static constexpr size_t progress_interval = 10000;
+
+chain_index::chain_index(server_node& node, const configuration& configuration,
+    const std::string& name)
+  : chain_index(node, configuration, name,
+        configuration.database.index_start_height, false)
+{
+}
+
+chain_index::chain_index(server_node& node, const configuration& configuration,
+    const std::string& name, size_t start_height, bool headers_only)
+  : node_(node),
+    start_height_(start_height),
+    depth_(configuration.chain.reorganization_limit == 0 ? default_depth :
+        configuration.chain.reorganization_limit),
+    dispatch_(node.thread_pool(), name + "_dispatch"),
+    name_(name),
+    headers_only_(headers_only),
+    window_size_(headers_only ? header_window_size : block_window_size),
+    synchronized_(false),
+    next_(start_height_),
+    window_end_(start_height_),
+    epoch_(0),
+    scanning_(false),
+    pending_(false),
+    top_hash_(null_hash)
+{
+}
+
+// There is no unsubscribe so this class shouldn't be restarted.
+bool chain_index::start()
+{
+    auto top_hash = null_hash;
+    const auto restored = load(top_hash);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+    next_ = start_height_ + restored;
+    top_hash_ = top_hash;
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Subscribe to blockchain reorganizations.
+    node_.subscribe_blockchain(
+        std::bind(&chain_index::handle_reorganization,
+            this, _1, _2, _3, _4));
+
+    if (restored == 0)
+    {
+        // Index from the start height to the current top of the chain.
+        catch_up();
+        return true;
+    }
+
+    // The restored top must still be of the chain, otherwise rebuild.
+    node_.chain().fetch_block_header(start_height_ + restored - 1,
+        std::bind(&chain_index::handle_restored,
+            this, _1, _2, top_hash));
+
+    return true;
+}
+
+// Properties.
+// ----------------------------------------------------------------------------
+
+bool chain_index::synchronized() const
+{
+    return synchronized_.load();
+}
+
+bool chain_index::top(size_t& height) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return indexed_top(height);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool chain_index::indexed_top(size_t& height) const
+{
+    if (next_ == start_height_)
+        return false;
+
+    height = next_ - 1;
+    return true;
+}
+
+// Derived indexes that persist no data are rebuilt on each start.
+size_t chain_index::load(hash_digest&)
+{
+    return 0;
+}
+
+// Derived indexes that require no store reads connect blocks as fetched.
+void chain_index::prepare(block_const_ptr, size_t, result_handler handler)
+{
+    handler(error::success);
+}
+
+// Scan.
+// ----------------------------------------------------------------------------
+
+// Only one scan runs at a time, a request during a scan restarts it on end.
+void chain_index::catch_up()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    if (scanning_)
+    {
+        pending_ = true;
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        return;
+    }
+
+    scanning_ = true;
+    pending_ = false;
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    scan();
+}
+
+void chain_index::scan()
+{
+    node_.chain().fetch_last_height(
+        std::bind(&chain_index::handle_last_height,
+            this, _1, _2));
+}
+
+void chain_index::finish_scan()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    const auto restart = pending_;
+    scanning_ = restart;
+    pending_ = false;
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (restart)
+        scan();
+}
+
+void chain_index::handle_restored(const code& ec, header_const_ptr header,
+    const hash_digest& top_hash)
+{
+    if (ec == error::service_stopped)
+        return;
+
+    auto rebuild = false;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    // A notification may have already moved the top from the restored block.
+    if (top_hash_ == top_hash && (ec || header->hash() != top_hash))
+    {
+        ++epoch_;
+        reset();
+        top_hash_ = null_hash;
+        next_ = start_height_;
+        rebuild = true;
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (rebuild)
+        LOG_WARNING(LOG_SERVER)
+            << "The restored " << name_ << " is not of the chain, "
+            << "rebuilding from height " << start_height_;
+
+    catch_up();
+}
+
+void chain_index::handle_last_height(const code& ec, size_t height)
+{
+    if (ec)
+    {
+        if (ec != error::service_stopped)
+            LOG_ERROR(LOG_SERVER)
+                << "Failure reading chain height for " << name_ << ": "
+                << ec.message();
+
+        finish_scan();
+        return;
+    }
+
+    size_t next;
+    size_t epoch;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+    next = next_;
+    epoch = epoch_;
+
+    // The window extent is recorded so that reorganizations above it do not
+    // invalidate it. Only one scan runs at a time, so there is one window.
+    window_end_ = next > height ? next :
+        next + std::min(window_size_, height - next + 1);
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (next > height)
+    {
+        if (!synchronized_.exchange(true))
+            LOG_INFO(LOG_SERVER)
+                << "The " << name_ << " is synchronized at height " << height;
+
+        finish_scan();
+        return;
+    }
+
+    synchronized_.store(false);
+    const auto count = std::min(window_size_, height - next + 1);
+    const auto blocks = std::make_shared<block_const_ptr_list>(count);
+
+    const auto complete = synchronize(
+        std::bind(&chain_index::handle_window,
+            this, _1, blocks, next, epoch), count, name_ + "_window");
+
+    const auto fetcher = headers_only_ ? &chain_index::fetch_header :
+        &chain_index::fetch;
+
+    for (size_t index = 0; index < count; ++index)
+        dispatch_.concurrent(fetcher,
+            this, next + index, blocks, index, complete);
+}
+
+void chain_index::fetch(size_t height, block_list_ptr blocks, size_t index,
+    result_handler complete)
+{
+    node_.chain().fetch_block(height,
+        std::bind(&chain_index::handle_block,
+            this, _1, _2, height, blocks, index, complete));
+}
+
+void chain_index::fetch_header(size_t height, block_list_ptr blocks,
+    size_t index, result_handler complete)
+{
+    node_.chain().fetch_block_header(height,
+        std::bind(&chain_index::handle_header,
+            this, _1, _2, height, blocks, index, complete));
+}
+
+// A header is connected as a block without transactions.
+void chain_index::handle_header(const code& ec, header_const_ptr header,
+    size_t height, block_list_ptr blocks, size_t index,
+    result_handler complete)
+{
+    if (ec)
+    {
+        complete(ec);
+        return;
+    }
+
+    const auto block = std::make_shared<const bc::message::block>(*header,
+        chain::transaction::list{});
+
+    handle_block(ec, block, height, blocks, index, complete);
+}
+
+void chain_index::handle_block(const code& ec, block_const_ptr block,
+    size_t height, block_list_ptr blocks, size_t index,
+    result_handler complete)
+{
+    if (ec)
+    {
+        complete(ec);
+        return;
+    }
+
+    // Each fetch writes a distinct element of the preallocated list.
+    (*blocks)[index] = block;
+    prepare(block, height, complete);
+}
+
+void chain_index::handle_window(const code& ec, block_list_ptr blocks,
+    size_t first, size_t epoch)
+{
+    if (ec)
+    {
+        if (ec != error::service_stopped)
+            LOG_ERROR(LOG_SERVER)
+                << "Failure reading block " << first << " for " << name_
+                << ": " << ec.message();
+
+        finish_scan();
+        return;
+    }
+
+    auto height = first;
+    auto linked = true;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    // A reorganization since the window was fetched may have invalidated it,
+    // in which case the window is discarded and read again.
+    if (epoch == epoch_)
+    {
+        height += link(*blocks, first);
+        linked = height == first + blocks->size();
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (height / progress_interval != first / progress_interval)
+        LOG_INFO(LOG_SERVER)
+            << "The " << name_ << " is indexed to height " << height - 1;
+
+    // The pending notification will restart the scan.
+    if (!linked)
+    {
+        finish_scan();
+        return;
+    }
+
+    scan();
+}
+
+// Link/Unlink.
+// ----------------------------------------------------------------------------
+
+size_t chain_index::link(const block_const_ptr_list& blocks, size_t first)
+{
+    auto height = first;
+
+    for (const auto block: blocks)
+    {
+        const auto& header = block->header();
+
+        // A missing link implies a reorganization not yet notified.
+        if (height != next_ || (next_ != start_height_ &&
+            header.previous_block_hash() != top_hash_) ||
+            !connect(block, height))
+            break;
+
+        top_hash_ = header.hash();
+        next_ = ++height;
+    }
+
+    return height - first;
+}
+
+// The top may instead be of the incoming branch if read after the
+// reorganization, in which case there is nothing to disconnect.
+bool chain_index::unlink(size_t fork_height,
+    const block_const_ptr_list& old_blocks)
+{
+    while (next_ > start_height_ && next_ > fork_height + 1)
+    {
+        const auto height = next_ - 1;
+        const auto offset = height - fork_height - 1;
+
+        if (offset >= old_blocks.size())
+            break;
+
+        const auto block = old_blocks[offset];
+        const auto& header = block->header();
+
+        if (header.hash() != top_hash_)
+            break;
+
+        if (!disconnect(block, height))
+        {
+            reset();
+            top_hash_ = null_hash;
+            next_ = start_height_;
+            return false;
+        }
+
+        top_hash_ = header.previous_block_hash();
+        next_ = height;
+    }
+
+    return true;
+}
+
+// Notification.
+// ----------------------------------------------------------------------------
+
+// The outgoing branch is disconnected here, the incoming branch is scanned.
+bool chain_index::handle_reorganization(const code& ec, size_t fork_height,
+    block_const_ptr_list_const_ptr new_blocks,
+    block_const_ptr_list_const_ptr old_blocks)
+{
+    if (ec == error::service_stopped)
+        return false;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure handling new block for " << name_ << ": "
+            << ec.message();
+
+        // Don't let a failure here prevent future notifications.
+        return true;
+    }
+
+    if (new_blocks->empty())
+        return true;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    // Only a fork within the window being read invalidates it. A window read
+    // wholly below the fork remains valid and links to the incoming branch.
+    if (fork_height + 1 < window_end_)
+        ++epoch_;
+
+    const auto rebuild = !unlink(fork_height, *old_blocks);
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (rebuild)
+        LOG_WARNING(LOG_SERVER)
+            << "Reorganization exceeds the undo depth of the " << name_
+            << ", rebuilding from height " << start_height_;
+
+    catch_up();
+    return true;
+}
+
+} // namespace server
+} // namespace libbitcoin
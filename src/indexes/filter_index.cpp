@@ -0,0 +1,423 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/indexes/filter_index.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/configuration.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/server_node.hpp>
+#include <bitcoin/server/utility/block_filter.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+#define NAME "filter_index"
+
+using namespace std::placeholders;
+using namespace bc::chain;
+using namespace boost::filesystem;
+
+// [ start_height:4 ]
+static constexpr size_t head_size = sizeof(uint32_t);
+
+// [ block_hash:32 ][ filter_header:32 ][ size:4 ][ filter ]
+static constexpr size_t record_size = 2 * hash_size + sizeof(uint32_t);
+
+filter_index::filter_index(server_node& node,
+    const configuration& configuration)
+  : chain_index(node, configuration, NAME),
+    path_(configuration.database.directory / NAME)
+{
+}
+
+// Properties.
+// ----------------------------------------------------------------------------
+
+bool filter_index::headers(size_t height, size_t count,
+    header_list& out) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    if (height < start_height_ || height - start_height_ >= entries_.size())
+        return false;
+
+    const auto first = entries_.begin() + (height - start_height_);
+    const auto end = first + std::min(count,
+        static_cast<size_t>(std::distance(first, entries_.end())));
+
+    out.reserve(std::distance(first, end));
+
+    for (auto it = first; it != end; ++it)
+        out.push_back({ it->block_hash, it->filter_header });
+
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool filter_index::filters(size_t height, size_t count,
+    filter_list& out) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    if (height < start_height_ || height - start_height_ >= entries_.size())
+        return false;
+
+    const auto first = entries_.begin() + (height - start_height_);
+    const auto end = first + std::min(count,
+        static_cast<size_t>(std::distance(first, entries_.end())));
+
+    // The file is only written under the exclusive lock.
+    std::ifstream file(path_.string(), std::ios::binary);
+    out.reserve(std::distance(first, end));
+
+    for (auto it = first; it != end; ++it)
+    {
+        data_chunk filter(it->size);
+        file.seekg(it->offset);
+        file.read(reinterpret_cast<char*>(filter.data()), filter.size());
+
+        if (!file)
+        {
+            LOG_ERROR(LOG_SERVER)
+                << "Failure reading the " NAME " file.";
+            return false;
+        }
+
+        out.push_back({ it->block_hash, it->filter_header, std::move(filter) });
+    }
+
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Persistence.
+// ----------------------------------------------------------------------------
+
+// Records are restored up to the first that is incomplete, which is dropped.
+size_t filter_index::load(hash_digest& top_hash)
+{
+    boost::system::error_code ec;
+    const auto size = exists(path_, ec) ? file_size(path_, ec) : 0;
+    std::ifstream file(path_.string(), std::ios::binary);
+    data_chunk head(head_size);
+    uint64_t end = 0;
+
+    entries_.clear();
+
+    if (!ec && file.read(reinterpret_cast<char*>(head.data()), head.size()))
+    {
+        auto deserial = make_safe_deserializer(head.begin(), head.end());
+
+        // An index from another start height is discarded.
+        if (deserial.read_4_bytes_little_endian() == start_height_)
+            end = head_size;
+    }
+
+    data_chunk record(record_size);
+
+    while (end != 0 && end + record_size <= size)
+    {
+        file.seekg(end);
+
+        if (!file.read(reinterpret_cast<char*>(record.data()), record.size()))
+            break;
+
+        auto deserial = make_safe_deserializer(record.begin(), record.end());
+        const auto block_hash = deserial.read_hash();
+        const auto filter_header = deserial.read_hash();
+        const auto filter_size = deserial.read_4_bytes_little_endian();
+        const auto offset = end + record_size;
+
+        if (offset + filter_size > size)
+            break;
+
+        entries_.push_back({ block_hash, filter_header, offset, filter_size });
+        end = offset + filter_size;
+    }
+
+    file.close();
+
+    if (!open(end))
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "Failure opening the " NAME " file " << path_;
+        entries_.clear();
+        return 0;
+    }
+
+    if (entries_.empty())
+        return 0;
+
+    top_hash = entries_.back().block_hash;
+
+    LOG_INFO(LOG_SERVER)
+        << "The " NAME " is restored to height "
+        << start_height_ + entries_.size() - 1;
+
+    return entries_.size();
+}
+
+// Truncate the file to the size and open it for appending.
+bool filter_index::open(uint64_t size)
+{
+    file_.close();
+    file_.clear();
+
+    if (size == 0)
+    {
+        BITCOIN_ASSERT(start_height_ <= max_uint32);
+        data_chunk head(head_size);
+        auto serial = make_unsafe_serializer(head.begin());
+        serial.write_4_bytes_little_endian(static_cast<uint32_t>(start_height_));
+
+        file_.open(path_.string(), std::ios::binary | std::ios::trunc);
+        file_.write(reinterpret_cast<const char*>(head.data()), head.size());
+        file_.flush();
+        return file_.good();
+    }
+
+    boost::system::error_code ec;
+    resize_file(path_, size, ec);
+
+    if (ec)
+        return false;
+
+    file_.open(path_.string(), std::ios::binary | std::ios::app);
+    return file_.good();
+}
+
+// Prepare.
+// ----------------------------------------------------------------------------
+
+// Resolve the script of each output spent by the block and build the filter.
+void filter_index::prepare(block_const_ptr block, size_t height,
+    result_handler handler)
+{
+    typedef std::pair<output_point, size_t> remote_point;
+
+    const auto& txs = block->transactions();
+    std::unordered_map<hash_digest, const transaction*> local;
+    size_t inputs = 0;
+
+    for (const auto& tx: txs)
+    {
+        local.emplace(tx.hash(), &tx);
+        inputs += tx.is_coinbase() ? 0 : tx.inputs().size();
+    }
+
+    const auto scripts = std::make_shared<data_stack>(inputs);
+    std::vector<remote_point> remote;
+    size_t slot = 0;
+
+    for (const auto& tx: txs)
+    {
+        if (tx.is_coinbase())
+            continue;
+
+        for (const auto& input: tx.inputs())
+        {
+            const auto& prevout = input.previous_output();
+            const auto it = local.find(prevout.hash());
+
+            // Outputs created within the block are resolved from the block.
+            if (it == local.end())
+                remote.push_back({ prevout, slot });
+            else if (prevout.index() < it->second->outputs().size())
+                (*scripts)[slot] = it->second->outputs()[prevout.index()]
+                    .script().to_data(false);
+
+            ++slot;
+        }
+    }
+
+    if (remote.empty())
+    {
+        handle_prepared(error::success, block, height, scripts, handler);
+        return;
+    }
+
+    const auto complete = synchronize(
+        std::bind(&filter_index::handle_prepared,
+            this, _1, block, height, scripts, handler),
+        remote.size(), NAME "_prepare");
+
+    for (const auto& point: remote)
+        node_.chain().fetch_transaction(point.first.hash(), true,
+            std::bind(&filter_index::handle_prevout,
+                this, _1, _2, point.first, point.second, scripts, complete));
+}
+
+void filter_index::handle_prevout(const code& ec, transaction_const_ptr tx,
+    const output_point& prevout, size_t slot, scripts_ptr scripts,
+    result_handler complete)
+{
+    if (ec)
+    {
+        complete(ec);
+        return;
+    }
+
+    // Each lookup writes a distinct element of the preallocated list.
+    if (prevout.index() < tx->outputs().size())
+        (*scripts)[slot] = tx->outputs()[prevout.index()].script()
+            .to_data(false);
+
+    complete(error::success);
+}
+
+// Filters of a window are constructed concurrently.
+void filter_index::handle_prepared(const code& ec, block_const_ptr block,
+    size_t height, scripts_ptr scripts, result_handler handler)
+{
+    if (ec)
+    {
+        handler(ec);
+        return;
+    }
+
+    auto filter = block_filter::compute(*block, *scripts);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    prepared_mutex_.lock();
+    prepared_[height] = prepared{ block->header().hash(), std::move(filter) };
+    prepared_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    handler(error::success);
+}
+
+// Connect/Disconnect.
+// ----------------------------------------------------------------------------
+
+bool filter_index::connect(block_const_ptr block, size_t height)
+{
+    prepared item;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    prepared_mutex_.lock();
+
+    const auto it = prepared_.find(height);
+    const auto found = it != prepared_.end() &&
+        it->second.block_hash == block->header().hash();
+
+    if (found)
+    {
+        item = std::move(it->second);
+
+        // Preparations at or below this height are obsolete.
+        prepared_.erase(prepared_.begin(), std::next(it));
+    }
+
+    prepared_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (!found)
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "The " NAME " is missing block " << height << " preparation.";
+        return false;
+    }
+
+    const auto previous = entries_.empty() ? null_hash :
+        entries_.back().filter_header;
+    const auto end = entries_.empty() ? head_size :
+        entries_.back().offset + entries_.back().size;
+
+    BITCOIN_ASSERT(item.filter.size() <= max_uint32);
+    const auto size = static_cast<uint32_t>(item.filter.size());
+    const entry row{ item.block_hash,
+        block_filter::header(item.filter, previous), end + record_size, size };
+
+    data_chunk record(record_size);
+    auto serial = make_unsafe_serializer(record.begin());
+    serial.write_hash(row.block_hash);
+    serial.write_hash(row.filter_header);
+    serial.write_4_bytes_little_endian(row.size);
+
+    file_.write(reinterpret_cast<const char*>(record.data()), record.size());
+    file_.write(reinterpret_cast<const char*>(item.filter.data()), size);
+    file_.flush();
+
+    if (!file_)
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "Failure writing the " NAME " file " << path_;
+
+        // Drop a partial record so that a retry appends in place.
+        open(end);
+        return false;
+    }
+
+    entries_.push_back(row);
+    return true;
+}
+
+// Any depth may be disconnected, as all filters are retained.
+bool filter_index::disconnect(block_const_ptr, size_t)
+{
+    if (entries_.empty())
+        return false;
+
+    const auto end = entries_.back().offset - record_size;
+    entries_.pop_back();
+
+    if (!open(end))
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "Failure truncating the " NAME " file " << path_;
+        return false;
+    }
+
+    return true;
+}
+
+void filter_index::reset()
+{
+    entries_.clear();
+
+    if (!open(0))
+        LOG_ERROR(LOG_SERVER)
+            << "Failure resetting the " NAME " file " << path_;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    prepared_mutex_.lock();
+    prepared_.clear();
+    prepared_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/indexes/header_index.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/configuration.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/indexes/chain_index.hpp>
+#include <bitcoin/server/server_node.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+#define NAME "header_index"
+
+using namespace bc::chain;
+
+// The size of a serialized block header.
+static constexpr size_t header_size = 80;
+
+// The offset of the timestamp within a serialized block header.
+static constexpr size_t timestamp_offset = 68;
+
+// The number of blocks in the median time past of a block.
+static constexpr size_t median_time_span = 11;
+
+// Headers are indexed from genesis regardless of the index start height.
+header_index::header_index(server_node& node,
+    const configuration& configuration)
+  : chain_index(node, configuration, NAME, 0, true)
+{
+}
+
+// Properties.
+// ----------------------------------------------------------------------------
+
+// The headers are copied from the array in one operation.
+bool header_index::headers(size_t height, size_t count, data_chunk& out,
+    size_t& appended) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    const auto indexed = this->count();
+
+    if (height >= indexed)
+        return false;
+
+    appended = std::min(count, indexed - height);
+    const auto first = headers_.begin() + height * header_size;
+    out.insert(out.end(), first, first + appended * header_size);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// A binary search, which relies upon median time past monotonicity.
+bool header_index::height_by_time(uint32_t time, size_t& height) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    const auto it = std::lower_bound(median_times_.begin(),
+        median_times_.end(), time);
+
+    if (it == median_times_.end())
+        return false;
+
+    height = std::distance(median_times_.begin(), it);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The number of indexed headers, caller must hold the mutex.
+size_t header_index::count() const
+{
+    return headers_.size() / header_size;
+}
+
+// Drop headers above the count, caller must hold the exclusive mutex.
+void header_index::truncate(size_t count)
+{
+    headers_.resize(count * header_size);
+    median_times_.resize(count);
+}
+
+// Index.
+// ----------------------------------------------------------------------------
+
+// The block is linked to the top by the chain index, it has no transactions.
+bool header_index::connect(block_const_ptr block, size_t height)
+{
+    BITCOIN_ASSERT(height == count());
+    const auto data = block->header().to_data();
+    BITCOIN_ASSERT(data.size() == header_size);
+    headers_.insert(headers_.end(), data.begin(), data.end());
+
+    // The median of the timestamps of the block and up to ten before it.
+    const auto indexed = count();
+    const auto span = std::min(indexed, median_time_span);
+    std::vector<uint32_t> times;
+    times.reserve(span);
+
+    for (auto index = indexed - span; index < indexed; ++index)
+    {
+        const auto time = headers_.begin() + index * header_size +
+            timestamp_offset;
+        times.push_back(from_little_endian_unsafe<uint32_t>(time));
+    }
+
+    std::sort(times.begin(), times.end());
+    median_times_.push_back(times[times.size() / 2]);
+    return true;
+}
+
+// Headers are retained to genesis, so any depth can be disconnected.
+bool header_index::disconnect(block_const_ptr, size_t height)
+{
+    BITCOIN_ASSERT(height + 1 == count());
+    truncate(height);
+    return true;
+}
+
+void header_index::reset()
+{
+    truncate(0);
+}
+
+} // namespace server
+} // namespace libbitcoin
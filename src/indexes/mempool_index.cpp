@@ -0,0 +1,284 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/indexes/mempool_index.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/server_node.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace std::placeholders;
+using namespace bc::chain;
+
+mempool_index::mempool_index(server_node& node,
+    const asio::duration& lifetime)
+  : node_(node),
+    lifetime_(lifetime)
+{
+}
+
+// There is no unsubscribe so this class shouldn't be restarted.
+bool mempool_index::start()
+{
+    // Subscribe to blockchain reorganizations.
+    node_.subscribe_blockchain(
+        std::bind(&mempool_index::handle_reorganization,
+            this, _1, _2, _3, _4));
+
+    // Subscribe to transaction pool acceptances.
+    node_.subscribe_transaction(
+        std::bind(&mempool_index::handle_transaction,
+            this, _1, _2));
+
+    return true;
+}
+
+// Properties.
+// ----------------------------------------------------------------------------
+
+void mempool_index::history(const short_hash& hash,
+    history_compact::list& out) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    const auto it = history_.find(hash);
+
+    if (it != history_.end())
+        out.insert(out.end(), it->second.begin(), it->second.end());
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Entries.
+// ----------------------------------------------------------------------------
+
+void mempool_index::add(const transaction& tx, const asio::time_point& expiry)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    insert(tx, expiry);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void mempool_index::remove(const hash_digest& tx_hash)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    erase(tx_hash);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void mempool_index::purge(const asio::time_point& now)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    expire(now);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void mempool_index::reorganize(const block_const_ptr_list& new_blocks,
+    const block_const_ptr_list& old_blocks, const asio::time_point& now)
+{
+    const auto expiry = now + lifetime_;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    expire(now);
+
+    // Transactions of the outgoing branch return to the pool, except coinbase.
+    for (const auto block: old_blocks)
+        for (const auto& tx: block->transactions())
+            if (!tx.is_coinbase())
+                insert(tx, expiry);
+
+    // Confirmed transactions are no longer indexed as unconfirmed.
+    for (const auto block: new_blocks)
+        for (const auto& tx: block->transactions())
+            erase(tx.hash());
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Index.
+// ----------------------------------------------------------------------------
+
+// Index the rows of a transaction, caller must hold the exclusive mutex.
+// see data_base::push_inputs and data_base::push_outputs
+void mempool_index::insert(const transaction& tx,
+    const asio::time_point& expiry)
+{
+    const auto tx_hash = tx.hash();
+    const auto& inputs = tx.inputs();
+    const auto& outputs = tx.outputs();
+    std::vector<short_hash> addresses;
+
+    if (addresses_.find(tx_hash) != addresses_.end())
+        return;
+
+    for (uint32_t index = 0; index < inputs.size(); ++index)
+    {
+        const auto& input = inputs[index];
+        const auto address = input.address();
+
+        if (!address)
+            continue;
+
+        history_compact row;
+        row.kind = point_kind::spend;
+        row.point = point{ tx_hash, index };
+        row.height = 0;
+        row.previous_checksum = input.previous_output().checksum();
+        append(address.hash(), row, addresses);
+    }
+
+    for (uint32_t index = 0; index < outputs.size(); ++index)
+    {
+        const auto& output = outputs[index];
+        const auto address = output.address();
+
+        if (!address)
+            continue;
+
+        history_compact row;
+        row.kind = point_kind::output;
+        row.point = point{ tx_hash, index };
+        row.height = 0;
+        row.value = output.value();
+        append(address.hash(), row, addresses);
+    }
+
+    if (addresses.empty())
+        return;
+
+    addresses_.emplace(tx_hash, entry{ std::move(addresses), expiry });
+    queue_.emplace_back(tx_hash, expiry);
+}
+
+// Add a row, caller must hold the exclusive mutex.
+void mempool_index::append(const short_hash& hash, const history_compact& row,
+    std::vector<short_hash>& addresses)
+{
+    history_[hash].push_back(row);
+
+    if (std::find(addresses.begin(), addresses.end(), hash) ==
+        addresses.end())
+        addresses.push_back(hash);
+}
+
+// Remove the rows of a transaction, caller must hold the exclusive mutex.
+void mempool_index::erase(const hash_digest& tx_hash)
+{
+    const auto tx = addresses_.find(tx_hash);
+
+    if (tx == addresses_.end())
+        return;
+
+    for (const auto& hash: tx->second.first)
+    {
+        const auto it = history_.find(hash);
+
+        if (it == history_.end())
+            continue;
+
+        auto& rows = it->second;
+        rows.erase(std::remove_if(rows.begin(), rows.end(),
+            [&tx_hash](const history_compact& row)
+            {
+                return row.point.hash() == tx_hash;
+            }), rows.end());
+
+        if (rows.empty())
+            history_.erase(it);
+    }
+
+    addresses_.erase(tx);
+}
+
+// Remove expired transactions, caller must hold the exclusive mutex.
+void mempool_index::expire(const asio::time_point& now)
+{
+    // Skip those removed or since restored, as their expiry differs.
+    while (!queue_.empty() && queue_.front().second <= now)
+    {
+        const auto tx = addresses_.find(queue_.front().first);
+
+        if (tx != addresses_.end() &&
+            tx->second.second == queue_.front().second)
+            erase(queue_.front().first);
+
+        queue_.pop_front();
+    }
+}
+
+// Notification.
+// ----------------------------------------------------------------------------
+
+bool mempool_index::handle_reorganization(const code& ec, size_t,
+    block_const_ptr_list_const_ptr new_blocks,
+    block_const_ptr_list_const_ptr old_blocks)
+{
+    if (ec == error::service_stopped)
+        return false;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure handling new block: " << ec.message();
+
+        // Don't let a failure here prevent future notifications.
+        return true;
+    }
+
+    reorganize(*new_blocks, *old_blocks, asio::steady_clock::now());
+    return true;
+}
+
+bool mempool_index::handle_transaction(const code& ec,
+    transaction_const_ptr tx)
+{
+    if (ec == error::service_stopped)
+        return false;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure handling new transaction: " << ec.message();
+
+        // Don't let a failure here prevent future notifications.
+        return true;
+    }
+
+    add(*tx, asio::steady_clock::now() + lifetime_);
+    return true;
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,370 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/indexes/script_index.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/configuration.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/server_node.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+#define NAME "script_index"
+
+using namespace std::placeholders;
+using namespace bc::chain;
+
+// Static.
+// ----------------------------------------------------------------------------
+
+// The script is hashed without its length prefix.
+hash_digest script_index::to_script_hash(const script& script)
+{
+    return sha256_hash(script.to_data(false));
+}
+
+// Construct.
+// ----------------------------------------------------------------------------
+
+script_index::script_index(server_node& node,
+    const configuration& configuration)
+  : chain_index(node, configuration, NAME)
+{
+}
+
+// Properties.
+// ----------------------------------------------------------------------------
+
+bool script_index::history(const hash_digest& script_hash,
+    size_t from_height, size_t& height, history_compact::list& out) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    if (!indexed_top(height))
+        return false;
+
+    const auto it = history_.find(script_hash);
+
+    if (it == history_.end())
+        return true;
+
+    for (const auto& row: it->second)
+        if (row.height >= from_height)
+            out.push_back(row);
+
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool script_index::balance(const hash_digest& script_hash, size_t& height,
+    uint64_t& received, uint64_t& spent) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    if (!indexed_top(height))
+        return false;
+
+    const auto it = totals_.find(script_hash);
+    received = it == totals_.end() ? 0 : it->second.received;
+    spent = it == totals_.end() ? 0 : it->second.spent;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Prepare.
+// ----------------------------------------------------------------------------
+
+// Resolve the script hash and value of each output spent by the block.
+void script_index::prepare(block_const_ptr block, size_t height,
+    result_handler handler)
+{
+    typedef std::pair<output_point, size_t> remote_point;
+
+    const auto& txs = block->transactions();
+    std::unordered_map<hash_digest, const transaction*> local;
+    size_t inputs = 0;
+
+    for (const auto& tx: txs)
+    {
+        local.emplace(tx.hash(), &tx);
+        inputs += tx.is_coinbase() ? 0 : tx.inputs().size();
+    }
+
+    const auto spends = std::make_shared<std::vector<spend>>(inputs,
+        spend{ null_hash, 0 });
+
+    std::vector<remote_point> remote;
+    size_t slot = 0;
+
+    for (const auto& tx: txs)
+    {
+        if (tx.is_coinbase())
+            continue;
+
+        for (const auto& input: tx.inputs())
+        {
+            const auto& prevout = input.previous_output();
+            const auto it = local.find(prevout.hash());
+
+            // Outputs created within the block are resolved from the block.
+            if (it == local.end())
+                remote.push_back({ prevout, slot });
+            else if (prevout.index() < it->second->outputs().size())
+            {
+                const auto& output = it->second->outputs()[prevout.index()];
+                (*spends)[slot] = spend
+                {
+                    to_script_hash(output.script()),
+                    output.value()
+                };
+            }
+
+            ++slot;
+        }
+    }
+
+    if (remote.empty())
+    {
+        handle_prepared(error::success, block, height, spends, handler);
+        return;
+    }
+
+    const auto complete = synchronize(
+        std::bind(&script_index::handle_prepared,
+            this, _1, block, height, spends, handler),
+        remote.size(), NAME "_prepare");
+
+    for (const auto& point: remote)
+        node_.chain().fetch_transaction(point.first.hash(), true,
+            std::bind(&script_index::handle_prevout,
+                this, _1, _2, _3, point.first, point.second, spends,
+                    complete));
+}
+
+void script_index::handle_prevout(const code& ec, transaction_const_ptr tx,
+    size_t tx_height, const output_point& prevout, size_t slot,
+    spends_ptr spends, result_handler complete)
+{
+    if (ec)
+    {
+        complete(ec);
+        return;
+    }
+
+    // Outputs below the start height were never indexed.
+    if (tx_height >= start_height_ && prevout.index() < tx->outputs().size())
+    {
+        const auto& output = tx->outputs()[prevout.index()];
+
+        // Each lookup writes a distinct element of the preallocated list.
+        (*spends)[slot] = spend
+        {
+            to_script_hash(output.script()),
+            output.value()
+        };
+    }
+
+    complete(error::success);
+}
+
+void script_index::handle_prepared(const code& ec, block_const_ptr block,
+    size_t height, spends_ptr spends, result_handler handler)
+{
+    if (ec)
+    {
+        handler(ec);
+        return;
+    }
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    prepared_mutex_.lock();
+    prepared_[height] = prepared{ block->header().hash(), std::move(*spends) };
+    prepared_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    handler(error::success);
+}
+
+// Connect/Disconnect.
+// ----------------------------------------------------------------------------
+
+// Append a row, the script is recorded for disconnection.
+void script_index::add(const hash_digest& script_hash,
+    const history_compact& row, totals_map& record)
+{
+    history_[script_hash].push_back(row);
+    record.emplace(script_hash, totals{ 0, 0 });
+}
+
+bool script_index::connect(block_const_ptr block, size_t height)
+{
+    prepared entry;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    prepared_mutex_.lock();
+
+    const auto it = prepared_.find(height);
+    const auto found = it != prepared_.end() &&
+        it->second.block_hash == block->header().hash();
+
+    if (found)
+    {
+        entry = std::move(it->second);
+
+        // Preparations at or below this height are obsolete.
+        prepared_.erase(prepared_.begin(), std::next(it));
+    }
+
+    prepared_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (!found)
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "The " NAME " is missing block " << height << " preparation.";
+        return false;
+    }
+
+    // Rows of each script are appended in height order.
+    totals_map record;
+    size_t slot = 0;
+
+    for (const auto& tx: block->transactions())
+    {
+        const auto tx_hash = tx.hash();
+
+        if (!tx.is_coinbase())
+        {
+            const auto& inputs = tx.inputs();
+
+            for (uint32_t index = 0; index < inputs.size(); ++index)
+            {
+                const auto& spent = entry.spends[slot++];
+
+                if (spent.script_hash == null_hash)
+                    continue;
+
+                history_compact row;
+                row.kind = point_kind::spend;
+                row.point = point{ tx_hash, index };
+                row.height = height;
+                row.previous_checksum = inputs[index].previous_output()
+                    .checksum();
+                add(spent.script_hash, row, record);
+                record[spent.script_hash].spent += spent.value;
+            }
+        }
+
+        const auto& outputs = tx.outputs();
+
+        for (uint32_t index = 0; index < outputs.size(); ++index)
+        {
+            const auto& output = outputs[index];
+            const auto script_hash = to_script_hash(output.script());
+
+            history_compact row;
+            row.kind = point_kind::output;
+            row.point = point{ tx_hash, index };
+            row.height = height;
+            row.value = output.value();
+            add(script_hash, row, record);
+            record[script_hash].received += output.value();
+        }
+    }
+
+    for (const auto& row: record)
+    {
+        auto& total = totals_[row.first];
+        total.received += row.second.received;
+        total.spent += row.second.spent;
+    }
+
+    undo_.push_back(std::move(record));
+
+    if (undo_.size() > depth_)
+        undo_.pop_front();
+
+    return true;
+}
+
+// The rows of the block are the last of each script recorded for it.
+bool script_index::disconnect(block_const_ptr, size_t height)
+{
+    if (undo_.empty())
+        return false;
+
+    for (const auto& row: undo_.back())
+    {
+        const auto rows = history_.find(row.first);
+        BITCOIN_ASSERT(rows != history_.end());
+
+        auto& list = rows->second;
+
+        while (!list.empty() && list.back().height == height)
+            list.pop_back();
+
+        if (list.empty())
+            history_.erase(rows);
+
+        const auto it = totals_.find(row.first);
+        BITCOIN_ASSERT(it != totals_.end());
+
+        auto& total = it->second;
+        total.received -= row.second.received;
+        total.spent -= row.second.spent;
+
+        if (total.received == 0 && total.spent == 0)
+            totals_.erase(it);
+    }
+
+    undo_.pop_back();
+    return true;
+}
+
+void script_index::reset()
+{
+    history_.clear();
+    totals_.clear();
+    undo_.clear();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    prepared_mutex_.lock();
+    prepared_.clear();
+    prepared_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -18,6 +18,7 @@
  */
 #include <bitcoin/server/interface/address.hpp>
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <bitcoin/bitcoin.hpp>
@@ -68,6 +69,50 @@ void address::unsubscribe2(server_node& node, const message& request,
     handler(message(request, ec));
 }
 
+// [ script_hash:32 ]
+void address::subscribe_script(server_node& node, const message& request,
+    send_handler handler)
+{
+    const auto& data = request.data();
+
+    if (data.size() != hash_size)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    hash_digest script_hash;
+    std::copy(data.begin(), data.end(), script_hash.begin());
+
+    // May cause a notification to fire in addition to the response below.
+    const auto ec = node.subscribe_script(request.route(), request.id(),
+        script_hash, false);
+
+    handler(message(request, ec));
+}
+
+// [ script_hash:32 ]
+void address::unsubscribe_script(server_node& node, const message& request,
+    send_handler handler)
+{
+    const auto& data = request.data();
+
+    if (data.size() != hash_size)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    hash_digest script_hash;
+    std::copy(data.begin(), data.end(), script_hash.begin());
+
+    // May cause a notification to fire in addition to the response below.
+    const auto ec = node.subscribe_script(request.route(), request.id(),
+        script_hash, true);
+
+    handler(message(request, ec));
+}
+
 bool address::unwrap_subscribe2_args(binary& prefix_filter,
     const message& request)
 {
@@ -21,11 +21,16 @@
 #include <cstdint>
 #include <cstddef>
 #include <functional>
+#include <memory>
+#include <vector>
 #include <bitcoin/blockchain.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/server_node.hpp>
+#include <bitcoin/server/utility/account_scanner.hpp>
 #include <bitcoin/server/utility/fetch_helpers.hpp>
+#include <bitcoin/server/utility/merkle_cache.hpp>
+#include <bitcoin/server/utility/verdict_cache.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -79,6 +84,21 @@ void blockchain::fetch_transaction(server_node& node, const message& request,
             _1, _2, _3, _4, request, handler));
 }
 
+void blockchain::fetch_transactions(server_node& node,
+    const message& request, send_handler handler)
+{
+    hash_list hashes;
+
+    if (!unwrap_fetch_transactions_args(hashes, request))
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // The response is restricted to confirmed transactions.
+    fetch_transaction_list(node, hashes, true, request, handler);
+}
+
 void blockchain::fetch_last_height(server_node& node, const message& request,
     send_handler handler)
 {
@@ -112,6 +132,73 @@ void blockchain::last_height_fetched(const code& ec, size_t last_height,
     handler(message(request, result));
 }
 
+void blockchain::fetch_block(server_node& node, const message& request,
+    send_handler handler)
+{
+    const auto& data = request.data();
+
+    if (data.size() == hash_size)
+        blockchain::fetch_block_by_hash(node, request, handler);
+    else if (data.size() == sizeof(uint32_t))
+        blockchain::fetch_block_by_height(node, request, handler);
+    else
+        handler(message(request, error::bad_stream));
+}
+
+void blockchain::fetch_block_by_hash(server_node& node,
+    const message& request, send_handler handler)
+{
+    const auto& data = request.data();
+    BITCOIN_ASSERT(data.size() == hash_size);
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const auto block_hash = deserial.read_hash();
+
+    node.chain().fetch_block(block_hash,
+        std::bind(&blockchain::block_fetched,
+            _1, _2, _3, request, handler));
+}
+
+void blockchain::fetch_block_by_height(server_node& node,
+    const message& request, send_handler handler)
+{
+    const auto& data = request.data();
+    BITCOIN_ASSERT(data.size() == sizeof(uint32_t));
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const size_t height = deserial.read_4_bytes_little_endian();
+
+    node.chain().fetch_block(height,
+        std::bind(&blockchain::block_fetched,
+            _1, _2, _3, request, handler));
+}
+
+// The store provides the block as an object, so it is serialized once, into
+// a single response as is every other query.
+void blockchain::block_fetched(const code& ec, block_const_ptr block,
+    size_t height, const message& request, send_handler handler)
+{
+    if (ec)
+    {
+        handler(message(request, ec));
+        return;
+    }
+
+    BITCOIN_ASSERT(height <= max_uint32);
+
+    // [ code:4 ]
+    // [ height:4 ]
+    // [ block... ]
+    const auto result = build_chunk(
+    {
+        message::to_bytes(error::success),
+        to_little_endian(static_cast<uint32_t>(height)),
+        block->to_data(canonical_version)
+    });
+
+    handler(message(request, result));
+}
+
 void blockchain::fetch_block_header(server_node& node, const message& request,
     send_handler handler)
 {
@@ -167,6 +254,88 @@ void blockchain::block_header_fetched(const code& ec, header_const_ptr header,
     handler(message(request, result));
 }
 
+// [ height:4 ][ count:4 ]
+// Headers are returned from the height up to the count or the indexed top.
+void blockchain::fetch_block_headers(server_node& node,
+    const message& request, send_handler handler)
+{
+    static constexpr size_t header_limit = 2000;
+    const auto& data = request.data();
+
+    if (data.size() != 2 * sizeof(uint32_t))
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const size_t height = deserial.read_4_bytes_little_endian();
+    const size_t count = deserial.read_4_bytes_little_endian();
+
+    if (count == 0 || count > header_limit)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // The headers are appended to the result directly from the index.
+    data_chunk result(code_size + sizeof(uint32_t));
+    size_t appended;
+
+    if (!node.server_settings().header_index_enabled ||
+        !node.headers().headers(height, count, result, appended))
+    {
+        handler(message(request, error::not_found));
+        return;
+    }
+
+    // [ code:4 ]
+    // [ count:4 ]
+    // [[ header:80 ]...]
+    auto serial = make_unsafe_serializer(result.begin());
+    serial.write_error_code(error::success);
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(appended));
+    handler(message(request, result));
+}
+
+// [ time:4 ]
+// The height is read from the header index, which must be enabled.
+void blockchain::fetch_height_by_time(server_node& node,
+    const message& request, send_handler handler)
+{
+    const auto& data = request.data();
+
+    if (data.size() != sizeof(uint32_t))
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const auto time = deserial.read_4_bytes_little_endian();
+    size_t height;
+
+    if (!node.server_settings().header_index_enabled ||
+        !node.headers().height_by_time(time, height))
+    {
+        handler(message(request, error::not_found));
+        return;
+    }
+
+    BITCOIN_ASSERT(height <= max_uint32);
+    const auto height32 = static_cast<uint32_t>(height);
+
+    // [ code:4 ]
+    // [ height:4 ]
+    const auto result = build_chunk(
+    {
+        message::to_bytes(error::success),
+        to_little_endian(height32)
+    });
+
+    handler(message(request, result));
+}
+
 void blockchain::fetch_block_transaction_hashes(server_node& node,
     const message& request, send_handler handler)
 {
@@ -221,6 +390,120 @@ void blockchain::merkle_block_fetched(const code& ec, merkle_block_ptr block,
     handler(message(request, result));
 }
 
+void blockchain::fetch_merkle_proof(server_node& node,
+    const message& request, send_handler handler)
+{
+    const auto& data = request.data();
+
+    if (data.size() != hash_size)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const auto tx_hash = deserial.read_hash();
+
+    // The proof is restricted to confirmed transactions.
+    node.chain().fetch_transaction_position(tx_hash, true,
+        std::bind(&blockchain::proof_position_fetched,
+            std::ref(node), _1, _2, _3, tx_hash, request, handler));
+}
+
+void blockchain::proof_position_fetched(server_node& node, const code& ec,
+    size_t tx_position, size_t block_height, const hash_digest& tx_hash,
+    const message& request, send_handler handler)
+{
+    if (ec)
+    {
+        handler(message(request, ec));
+        return;
+    }
+
+    // The cached tree is keyed by the hash of the block at the height.
+    node.chain().fetch_block_header(block_height,
+        std::bind(&blockchain::proof_header_fetched,
+            std::ref(node), _1, _2, block_height, tx_position, tx_hash,
+                request, handler));
+}
+
+void blockchain::proof_header_fetched(server_node& node, const code& ec,
+    header_const_ptr header, size_t block_height, size_t tx_position,
+    const hash_digest& tx_hash, const message& request, send_handler handler)
+{
+    if (ec)
+    {
+        handler(message(request, ec));
+        return;
+    }
+
+    // Repeated proofs for a block are served from its cached tree.
+    const auto block_hash = header->hash();
+    const auto tree = node.merkle_trees().find(block_hash);
+
+    if (tree)
+    {
+        send_merkle_proof(*tree, block_height, tx_position, tx_hash, request,
+            handler);
+        return;
+    }
+
+    // The block is fetched by hash so that the tree matches its key.
+    node.chain().fetch_merkle_block(block_hash,
+        std::bind(&blockchain::proof_block_fetched,
+            std::ref(node), _1, _2, block_height, tx_position, tx_hash,
+                request, handler));
+}
+
+void blockchain::proof_block_fetched(server_node& node, const code& ec,
+    merkle_block_ptr block, size_t block_height, size_t tx_position,
+    const hash_digest& tx_hash, const message& request, send_handler handler)
+{
+    if (ec)
+    {
+        handler(message(request, ec));
+        return;
+    }
+
+    const auto tree = merkle_cache::build(block->hashes());
+    node.merkle_trees().store(block->header().hash(), tree);
+    send_merkle_proof(*tree, block_height, tx_position, tx_hash, request,
+        handler);
+}
+
+void blockchain::send_merkle_proof(const merkle_cache::tree& tree,
+    size_t block_height, size_t tx_position, const hash_digest& tx_hash,
+    const message& request, send_handler handler)
+{
+    // A reorganization between lookups may have moved the transaction.
+    if (tree.empty() || tx_position >= tree.front().size() ||
+        tree.front()[tx_position] != tx_hash)
+    {
+        handler(message(request, error::not_found));
+        return;
+    }
+
+    BITCOIN_ASSERT(block_height <= max_uint32);
+    BITCOIN_ASSERT(tx_position <= max_uint32);
+    const auto branch = merkle_cache::branch(tree, tx_position);
+
+    // [ code:4 ]
+    // [ height:4 ]
+    // [ position:4 ]
+    // [[ hash:32 ]...]
+    data_chunk result(code_size + 2 * sizeof(uint32_t) +
+        hash_size * branch.size());
+    auto serial = make_unsafe_serializer(result.begin());
+    serial.write_error_code(error::success);
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(block_height));
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(tx_position));
+
+    for (const auto& hash: branch)
+        serial.write_hash(hash);
+
+    handler(message(request, result));
+}
+
 void blockchain::fetch_transaction_index(server_node& node,
     const message& request, send_handler handler)
 {
@@ -302,6 +585,83 @@ void blockchain::spend_fetched(const code& ec, const chain::input_point& inpoint
     handler(message(request, result));
 }
 
+// [[ hash:32 ][ index:4 ]...]
+// Points are read in place from the request, lookups are dispatched
+// concurrently and the response is routed back by the query worker.
+void blockchain::fetch_spends(server_node& node, const message& request,
+    send_handler handler)
+{
+    static constexpr size_t item_size = code_size + point_size;
+
+    const auto& data = request.data();
+    const auto count = data.size() / point_size;
+
+    if (data.empty() || data.size() % point_size != 0 ||
+        count > query_batch_limit)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    const auto items = std::make_shared<data_chunk>(count * item_size);
+
+    const auto complete = synchronize(
+        std::bind(&blockchain::spends_fetched,
+            _1, items, request, handler),
+        count, "fetch_spends");
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+
+    for (size_t slot = 0; slot < count; ++slot)
+    {
+        const auto hash = deserial.read_hash();
+        const auto index = deserial.read_4_bytes_little_endian();
+
+        node.query_dispatch().concurrent(&blockchain::fetch_spend_item,
+            std::ref(node), output_point(hash, index), slot, items, complete);
+    }
+}
+
+void blockchain::fetch_spend_item(server_node& node,
+    const output_point& outpoint, size_t slot,
+    std::shared_ptr<data_chunk> items, result_handler complete)
+{
+    node.chain().fetch_spend(outpoint,
+        std::bind(&blockchain::spend_item_fetched,
+            _1, _2, slot, items, complete));
+}
+
+void blockchain::spend_item_fetched(const code& ec,
+    const input_point& inpoint, size_t slot,
+    std::shared_ptr<data_chunk> items, result_handler complete)
+{
+    static constexpr size_t item_size = code_size + point_size;
+
+    // Each lookup writes a distinct range of the preallocated result.
+    auto serial = make_unsafe_serializer(items->begin() + slot * item_size);
+    serial.write_error_code(ec);
+    serial.write_hash(inpoint.hash());
+    serial.write_4_bytes_little_endian(inpoint.index());
+
+    // A failed lookup is reported in its item, not for the batch.
+    complete(error::success);
+}
+
+void blockchain::spends_fetched(const code& ec,
+    std::shared_ptr<data_chunk> items, const message& request,
+    send_handler handler)
+{
+    // [ code:4 ]
+    // [[ code:4 ][ hash:32 ][ index:4 ]...]
+    const auto result = build_chunk(
+    {
+        message::to_bytes(ec),
+        *items
+    });
+
+    handler(message(request, result));
+}
+
 void blockchain::fetch_block_height(server_node& node,
     const message& request, send_handler handler)
 {
@@ -445,6 +805,486 @@ void blockchain::stealth_fetched2(const code& ec,
     handler(message(request, result));
 }
 
+// The balance is read from the address index, which must be enabled.
+void blockchain::fetch_balance(server_node& node, const message& request,
+    send_handler handler)
+{
+    const auto& data = request.data();
+
+    if (data.size() != short_hash_size)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const auto address_hash = deserial.read_short_hash();
+
+    size_t height;
+    uint64_t received;
+    uint64_t spent;
+
+    if (!node.server_settings().address_index_enabled ||
+        !node.addresses().balance(address_hash, height, received, spent))
+    {
+        handler(message(request, error::not_found));
+        return;
+    }
+
+    BITCOIN_ASSERT(height <= max_uint32);
+    const auto height32 = static_cast<uint32_t>(height);
+
+    // [ code:4 ]
+    // [ height:4 ]
+    // [ received:8 ]
+    // [ spent:8 ]
+    // [ balance:8 ]
+    const auto result = build_chunk(
+    {
+        message::to_bytes(error::success),
+        to_little_endian(height32),
+        to_little_endian(received),
+        to_little_endian(spent),
+        to_little_endian(received - spent)
+    });
+
+    handler(message(request, result));
+}
+
+// The outputs are read from the address index, which must be enabled.
+void blockchain::fetch_unspent(server_node& node, const message& request,
+    send_handler handler)
+{
+    static constexpr size_t row_size = point_size + sizeof(uint64_t) +
+        sizeof(uint32_t);
+
+    const auto& data = request.data();
+
+    if (data.size() != short_hash_size)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const auto address_hash = deserial.read_short_hash();
+
+    size_t height;
+    address_index::unspent_list outputs;
+
+    if (!node.server_settings().address_index_enabled ||
+        !node.addresses().unspent(address_hash, height, outputs))
+    {
+        handler(message(request, error::not_found));
+        return;
+    }
+
+    BITCOIN_ASSERT(height <= max_uint32);
+
+    // [ code:4 ]
+    // [ height:4 ]
+    // [[ hash:32 ][ index:4 ][ value:8 ][ height:4 ]...]
+    data_chunk result(code_size + sizeof(uint32_t) +
+        row_size * outputs.size());
+    auto serial = make_unsafe_serializer(result.begin());
+    serial.write_error_code(error::success);
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(height));
+
+    for (const auto& output: outputs)
+    {
+        BITCOIN_ASSERT(output.height <= max_uint32);
+        serial.write_hash(output.point.hash());
+        serial.write_4_bytes_little_endian(output.point.index());
+        serial.write_8_bytes_little_endian(output.value);
+        serial.write_4_bytes_little_endian(
+            static_cast<uint32_t>(output.height));
+    }
+
+    handler(message(request, result));
+}
+
+// [ script_hash:32 ][ from_height:4 ]
+// The history is read from the script index, which must be enabled.
+void blockchain::fetch_script_history(server_node& node,
+    const message& request, send_handler handler)
+{
+    const auto& data = request.data();
+
+    if (data.size() != hash_size + sizeof(uint32_t))
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const auto script_hash = deserial.read_hash();
+    const size_t from_height = deserial.read_4_bytes_little_endian();
+
+    size_t height;
+    history_compact::list history;
+
+    if (!node.server_settings().script_index_enabled ||
+        !node.scripts().history(script_hash, from_height, height, history))
+    {
+        handler(message(request, error::not_found));
+        return;
+    }
+
+    // The rows are those of blockchain.fetch_history2.
+    send_history_result(error::success, history, request, handler);
+}
+
+// [ script_hash:32 ]
+// The balance is read from the script index, which must be enabled.
+void blockchain::fetch_script_balance(server_node& node,
+    const message& request, send_handler handler)
+{
+    const auto& data = request.data();
+
+    if (data.size() != hash_size)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const auto script_hash = deserial.read_hash();
+
+    size_t height;
+    uint64_t received;
+    uint64_t spent;
+
+    if (!node.server_settings().script_index_enabled ||
+        !node.scripts().balance(script_hash, height, received, spent))
+    {
+        handler(message(request, error::not_found));
+        return;
+    }
+
+    BITCOIN_ASSERT(height <= max_uint32);
+    const auto height32 = static_cast<uint32_t>(height);
+
+    // [ code:4 ]
+    // [ height:4 ]
+    // [ received:8 ]
+    // [ spent:8 ]
+    // [ balance:8 ]
+    const auto result = build_chunk(
+    {
+        message::to_bytes(error::success),
+        to_little_endian(height32),
+        to_little_endian(received),
+        to_little_endian(spent),
+        to_little_endian(received - spent)
+    });
+
+    handler(message(request, result));
+}
+
+// The filter is read from the filter index, which must be enabled.
+void blockchain::fetch_filter(server_node& node, const message& request,
+    send_handler handler)
+{
+    const auto& data = request.data();
+
+    if (data.size() != sizeof(uint32_t))
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const size_t height = deserial.read_4_bytes_little_endian();
+    filter_index::filter_list filters;
+
+    if (!node.server_settings().filter_index_enabled ||
+        !node.filters().filters(height, 1, filters))
+    {
+        handler(message(request, error::not_found));
+        return;
+    }
+
+    const auto& row = filters.front();
+
+    // [ code:4 ]
+    // [ block_hash:32 ]
+    // [ filter_header:32 ]
+    // [ filter ]
+    const auto result = build_chunk(
+    {
+        message::to_bytes(error::success),
+        row.block_hash,
+        row.filter_header,
+        row.filter
+    });
+
+    handler(message(request, result));
+}
+
+// [ height:4 ][ count:4 ]
+// Headers are returned from the height up to the count or the indexed top.
+void blockchain::fetch_filter_headers(server_node& node,
+    const message& request, send_handler handler)
+{
+    static constexpr size_t header_limit = 2000;
+    static constexpr size_t row_size = 2 * hash_size;
+
+    const auto& data = request.data();
+
+    if (data.size() != 2 * sizeof(uint32_t))
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const size_t height = deserial.read_4_bytes_little_endian();
+    const size_t count = deserial.read_4_bytes_little_endian();
+
+    if (count == 0 || count > header_limit)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    filter_index::header_list headers;
+
+    if (!node.server_settings().filter_index_enabled ||
+        !node.filters().headers(height, count, headers))
+    {
+        handler(message(request, error::not_found));
+        return;
+    }
+
+    // [ code:4 ]
+    // [ count:4 ]
+    // [[ block_hash:32 ][ filter_header:32 ]...]
+    data_chunk result(code_size + sizeof(uint32_t) +
+        row_size * headers.size());
+    auto serial = make_unsafe_serializer(result.begin());
+    serial.write_error_code(error::success);
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(headers.size()));
+
+    for (const auto& row: headers)
+    {
+        serial.write_hash(row.block_hash);
+        serial.write_hash(row.filter_header);
+    }
+
+    handler(message(request, result));
+}
+
+// [ height:4 ][ count:4 ]
+// Filters are returned from the height up to the count or the indexed top.
+void blockchain::fetch_filters(server_node& node, const message& request,
+    send_handler handler)
+{
+    static constexpr size_t filter_limit = 100;
+    static constexpr size_t row_size = hash_size + sizeof(uint32_t);
+
+    const auto& data = request.data();
+
+    if (data.size() != 2 * sizeof(uint32_t))
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const size_t height = deserial.read_4_bytes_little_endian();
+    const size_t count = deserial.read_4_bytes_little_endian();
+
+    if (count == 0 || count > filter_limit)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    filter_index::filter_list filters;
+
+    if (!node.server_settings().filter_index_enabled ||
+        !node.filters().filters(height, count, filters))
+    {
+        handler(message(request, error::not_found));
+        return;
+    }
+
+    auto size = code_size + sizeof(uint32_t);
+
+    for (const auto& row: filters)
+        size += row_size + row.filter.size();
+
+    // [ code:4 ]
+    // [ count:4 ]
+    // [[ block_hash:32 ][ size:4 ][ filter ]...]
+    data_chunk result(size);
+    auto serial = make_unsafe_serializer(result.begin());
+    serial.write_error_code(error::success);
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(filters.size()));
+
+    for (const auto& row: filters)
+    {
+        serial.write_hash(row.block_hash);
+        serial.write_4_bytes_little_endian(
+            static_cast<uint32_t>(row.filter.size()));
+        serial.write_bytes(row.filter);
+    }
+
+    handler(message(request, result));
+}
+
+// [ target_blocks:4 ]
+// The estimate is answered from statistics maintained as blocks arrive.
+void blockchain::estimate_fee(server_node& node, const message& request,
+    send_handler handler)
+{
+    const auto& data = request.data();
+
+    if (data.size() != sizeof(uint32_t))
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const size_t target = deserial.read_4_bytes_little_endian();
+
+    if (target == 0 || target > fee_estimator::max_target)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    uint64_t rate;
+
+    if (!node.fee_estimates().estimate(target, rate))
+    {
+        handler(message(request, error::not_found));
+        return;
+    }
+
+    // [ code:4 ]
+    // [ rate:8 ] (satoshis per byte)
+    const auto result = build_chunk(
+    {
+        message::to_bytes(error::success),
+        to_little_endian(rate)
+    });
+
+    handler(message(request, result));
+}
+
+// [ key:78 ][ version:1 ][ gap_limit:4 ][ from_height:4 ][ count:1 ]
+// [[ chain:4 ]...]
+// The key is the serialized extended public key without its checksum.
+void blockchain::fetch_account_history(server_node& node,
+    const message& request, send_handler handler)
+{
+    static constexpr size_t key_size = hd_key_size - checksum_size;
+    static constexpr size_t fixed_size = key_size + sizeof(uint8_t) +
+        sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint8_t);
+    static constexpr uint32_t maximum_gap_limit = 1000;
+
+    const auto& data = request.data();
+
+    if (data.size() < fixed_size)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    auto key_data = deserial.read_bytes(key_size);
+    const auto version = deserial.read_byte();
+    const auto gap_limit = deserial.read_4_bytes_little_endian();
+    const size_t from_height = deserial.read_4_bytes_little_endian();
+    const auto count = deserial.read_byte();
+
+    if (data.size() != fixed_size + count * sizeof(uint32_t) ||
+        gap_limit == 0 || gap_limit > maximum_gap_limit)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    std::vector<uint32_t> chains;
+    chains.reserve(count);
+
+    for (size_t chain = 0; chain < count; ++chain)
+        chains.push_back(deserial.read_4_bytes_little_endian());
+
+    // The key prefix is the leading four bytes of the serialized key.
+    append_checksum(key_data);
+    const auto prefix = from_big_endian_unsafe<uint32_t>(key_data.begin());
+    const hd_public key(to_array<hd_key_size>(key_data), prefix);
+
+    if (!key)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    LOG_DEBUG(LOG_SERVER)
+        << "blockchain.fetch_account_history(" << key.encoded()
+        << ", gap_limit=" << gap_limit << ", from_height=" << from_height
+        << ")";
+
+    const auto scanner = std::make_shared<account_scanner>(node, key,
+        version, gap_limit, from_height);
+
+    scanner->start(chains,
+        std::bind(&blockchain::account_history_fetched,
+            _1, _2, request, handler));
+}
+
+void blockchain::account_history_fetched(const code& ec,
+    const account_scanner::list& used, const message& request,
+    send_handler handler)
+{
+    static constexpr size_t address_size = sizeof(uint32_t) +
+        sizeof(uint32_t) + short_hash_size + sizeof(uint32_t);
+    static constexpr size_t row_size = sizeof(uint8_t) + point_size +
+        sizeof(uint32_t) + sizeof(uint64_t);
+
+    if (ec)
+    {
+        handler(message(request, ec));
+        return;
+    }
+
+    auto size = code_size;
+
+    for (const auto& address: used)
+        size += address_size + row_size * address.history.size();
+
+    // [ code:4 ]
+    // [[ chain:4 ][ index:4 ][ hash:20 ][ count:4 ]
+    //  [[ kind:1 ][ point:36 ][ height:4 ][ value:8 ]...]...]
+    data_chunk result(size);
+    auto serial = make_unsafe_serializer(result.begin());
+    serial.write_error_code(ec);
+
+    for (const auto& address: used)
+    {
+        serial.write_4_bytes_little_endian(address.chain);
+        serial.write_4_bytes_little_endian(address.index);
+        serial.write_short_hash(address.hash);
+        serial.write_4_bytes_little_endian(
+            static_cast<uint32_t>(address.history.size()));
+
+        for (const auto& row: address.history)
+        {
+            BITCOIN_ASSERT(row.height <= max_uint32);
+            serial.write_byte(static_cast<uint8_t>(row.kind));
+            serial.write_bytes(row.point.to_data());
+            serial.write_4_bytes_little_endian(row.height);
+            serial.write_8_bytes_little_endian(row.value);
+        }
+    }
+
+    handler(message(request, result));
+}
+
 // Save to blockchain and announce to all connected peers.
 void blockchain::broadcast(server_node& node, const message& request,
     send_handler handler)
@@ -473,9 +1313,50 @@ void blockchain::handle_broadcast(const code& ec, const message& request,
     handler(message(request, ec));
 }
 
+// A verdict depends upon the chain, so it is cached by payload and chain top.
+// A verdict reached against a top that has since been reorganized out cannot
+// be matched, even if stored after the cache is cleared by reorganization.
 void blockchain::validate(server_node& node, const message& request,
     send_handler handler)
 {
+    node.chain().fetch_last_height(
+        std::bind(&blockchain::handle_validate_height,
+            std::ref(node), _1, _2, request, handler));
+}
+
+void blockchain::handle_validate_height(server_node& node, const code& ec,
+    size_t height, const message& request, send_handler handler)
+{
+    if (ec)
+    {
+        handler(message(request, ec));
+        return;
+    }
+
+    node.chain().fetch_block_header(height,
+        std::bind(&blockchain::handle_validate_header,
+            std::ref(node), _1, _2, request, handler));
+}
+
+void blockchain::handle_validate_header(server_node& node, const code& ec,
+    header_const_ptr header, const message& request, send_handler handler)
+{
+    if (ec)
+    {
+        handler(message(request, ec));
+        return;
+    }
+
+    const auto key = bitcoin_hash(build_chunk({ request.data(),
+        header->hash() }));
+    code verdict;
+
+    if (node.validations().find(key, verdict))
+    {
+        handler(message(request, verdict));
+        return;
+    }
+
     const auto block = std::make_shared<bc::message::block>();
 
     if (!block->from_data(canonical_version, request.data()))
@@ -489,12 +1370,17 @@ void blockchain::validate(server_node& node, const message& request,
 
     // This call is async but blocks on other organizations until started.
     node.chain().organize(block,
-        std::bind(handle_validated, _1, request, handler));
+        std::bind(handle_validated,
+            std::ref(node), _1, key, request, handler));
 }
 
-void blockchain::handle_validated(const code& ec, const message& request,
-    send_handler handler)
+// Failures are not cached, as they may depend upon the pool or chain.
+void blockchain::handle_validated(server_node& node, const code& ec,
+    const hash_digest& key, const message& request, send_handler handler)
 {
+    if (!ec)
+        node.validations().store(key, ec);
+
     // Returns validation error or error::success.
     handler(message(request, ec));
 }
@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/interface/statistics.hpp>
+
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/messages/message.hpp>
+#include <bitcoin/server/server_node.hpp>
+#include <bitcoin/server/utility/relay_monitor.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+// The service identifiers of relay statistics rows.
+static constexpr uint8_t block_relay = 0;
+static constexpr uint8_t transaction_relay = 1;
+
+// [ service:1 ]
+// [ secure:1 ]
+// [ forwarded_messages:8 ]
+// [ forwarded_bytes:8 ]
+// [ subscriptions:4 ]
+// [ worker_backlog:4 ]
+// [ peak_worker_backlog:4 ]
+static data_chunk to_relay_row(uint8_t service, bool secure,
+    const relay_monitor& monitor)
+{
+    return build_chunk(
+    {
+        to_array(service),
+        to_array(secure ? 1 : 0),
+        to_little_endian(monitor.forwarded_messages()),
+        to_little_endian(monitor.forwarded_bytes()),
+        to_little_endian(monitor.subscriptions()),
+        to_little_endian(monitor.worker_backlog()),
+        to_little_endian(monitor.peak_worker_backlog())
+    });
+}
+
+void statistics::fetch_relays(server_node& node, const message& request,
+    send_handler handler)
+{
+    if (!request.data().empty())
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // [ code:4 ]
+    // [[ relay_row ]...]
+    const auto result = build_chunk(
+    {
+        message::to_bytes(error::success),
+        to_relay_row(block_relay, false, node.block_relay(false)),
+        to_relay_row(block_relay, true, node.block_relay(true)),
+        to_relay_row(transaction_relay, false, node.transaction_relay(false)),
+        to_relay_row(transaction_relay, true, node.transaction_relay(true))
+    });
+
+    handler(message(request, result));
+}
+
+// [ service:1 ]
+// [ secure:1 ]
+// [ serialization_histogram ]
+// [ handoff_histogram ]
+// [ send_histogram ]
+// [ latency_histogram ]
+static data_chunk to_latency_row(uint8_t service, bool secure,
+    const relay_monitor& monitor)
+{
+    return build_chunk(
+    {
+        to_array(service),
+        to_array(secure ? 1 : 0),
+        monitor.serialization().to_data(),
+        monitor.handoff().to_data(),
+        monitor.send().to_data(),
+        monitor.latency().to_data()
+    });
+}
+
+void statistics::fetch_latencies(server_node& node, const message& request,
+    send_handler handler)
+{
+    if (!request.data().empty())
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // [ code:4 ]
+    // [[ latency_row ]...]
+    const auto result = build_chunk(
+    {
+        message::to_bytes(error::success),
+        to_latency_row(block_relay, false, node.block_relay(false)),
+        to_latency_row(block_relay, true, node.block_relay(true)),
+        to_latency_row(transaction_relay, false, node.transaction_relay(false)),
+        to_latency_row(transaction_relay, true, node.transaction_relay(true))
+    });
+
+    handler(message(request, result));
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/interface/transaction.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/messages/message.hpp>
+#include <bitcoin/server/server_node.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+static constexpr size_t max_depths = 16;
+
+void transaction::subscribe_confirmations(server_node& node,
+    const message& request, send_handler handler)
+{
+    hash_digest tx_hash;
+    std::vector<uint32_t> depths;
+
+    if (!unwrap_subscribe_confirmations_args(tx_hash, depths, request))
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // May cause a notification to fire in addition to the response below.
+    const auto ec = node.subscribe_confirmations(request.route(),
+        request.id(), tx_hash, depths, false);
+
+    handler(message(request, ec));
+}
+
+// [ tx_hash:32 ]
+void transaction::unsubscribe_confirmations(server_node& node,
+    const message& request, send_handler handler)
+{
+    const auto& data = request.data();
+
+    if (data.size() != hash_size)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    hash_digest tx_hash;
+    std::copy(data.begin(), data.end(), tx_hash.begin());
+
+    const auto ec = node.subscribe_confirmations(request.route(),
+        request.id(), tx_hash, {}, true);
+
+    handler(message(request, ec));
+}
+
+bool transaction::unwrap_subscribe_confirmations_args(hash_digest& tx_hash,
+    std::vector<uint32_t>& depths, const message& request)
+{
+    // [ tx_hash:32 ]
+    // [ count:1 ]
+    // [[ depth:4 ]...]
+    const auto& data = request.data();
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    tx_hash = deserial.read_hash();
+    const size_t count = deserial.read_byte();
+
+    if (!deserial || count == 0 || count > max_depths)
+        return false;
+
+    for (size_t index = 0; index < count; ++index)
+        depths.push_back(deserial.read_4_bytes_little_endian());
+
+    if (!deserial || !deserial.is_exhausted())
+        return false;
+
+    // Depths are notified in ascending order, each once.
+    std::sort(depths.begin(), depths.end());
+    depths.erase(std::unique(depths.begin(), depths.end()), depths.end());
+    return depths.front() > 0;
+}
+
+} // namespace server
+} // namespace libbitcoin
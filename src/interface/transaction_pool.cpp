@@ -18,20 +18,48 @@
  */
 #include <bitcoin/server/interface/transaction_pool.hpp>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstddef>
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include <bitcoin/server/configuration.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/server_node.hpp>
 #include <bitcoin/server/utility/fetch_helpers.hpp>
+#include <bitcoin/server/utility/status_monitor.hpp>
+#include <bitcoin/server/utility/verdict_cache.hpp>
 
 namespace libbitcoin {
 namespace server {
 
 using namespace std::placeholders;
 
+// The transactions of a batch broadcast, their results and organize order.
+struct transaction_pool::broadcast_batch
+{
+    std::vector<transaction_ptr> txs;
+    std::vector<code> codes;
+    std::vector<size_t> order;
+};
+
+// A transaction and the previous output of each of its inputs.
+struct transaction_pool::prevout_query
+{
+    struct prevout
+    {
+        uint64_t value;
+        size_t height;
+        chain::script script;
+    };
+
+    transaction_const_ptr tx;
+    std::vector<prevout> prevouts;
+};
+
 void transaction_pool::fetch_transaction(server_node& node,
     const message& request, send_handler handler)
 {
@@ -49,12 +77,415 @@ void transaction_pool::fetch_transaction(server_node& node,
             _1, _2, _3, _4, request, handler));
 }
 
+void transaction_pool::fetch_transactions(server_node& node,
+    const message& request, send_handler handler)
+{
+    hash_list hashes;
+
+    if (!unwrap_fetch_transactions_args(hashes, request))
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // The response allows confirmed and unconfirmed transactions.
+    fetch_transaction_list(node, hashes, false, request, handler);
+}
+
+// The unconfirmed rows are read from the mempool index, if enabled.
+void transaction_pool::fetch_history(server_node& node,
+    const message& request, send_handler handler)
+{
+    static constexpr size_t limit = 0;
+    size_t from_height;
+    wallet::payment_address address;
+
+    if (!unwrap_fetch_history_args(address, from_height, request))
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    node.chain().fetch_history(address, limit, from_height,
+        std::bind(&transaction_pool::history_fetched,
+            std::ref(node), _1, _2, address.hash(), request, handler));
+}
+
+// Unconfirmed rows (zero height) precede the confirmed rows.
+void transaction_pool::history_fetched(server_node& node, const code& ec,
+    const chain::history_compact::list& history,
+    const short_hash& address_hash, const message& request,
+    send_handler handler)
+{
+    if (ec || !node.server_settings().mempool_index_enabled)
+    {
+        send_history_result(ec, history, request, handler);
+        return;
+    }
+
+    chain::history_compact::list merged;
+    node.mempool().history(address_hash, merged);
+    merged.insert(merged.end(), history.begin(), history.end());
+    send_history_result(error::success, merged, request, handler);
+}
+
+// [ hash:32 ] or [ tx ]
+// A serialized transaction cannot be the size of a hash.
+void transaction_pool::fetch_prevouts(server_node& node,
+    const message& request, send_handler handler)
+{
+    static const auto version = bc::message::version::level::canonical;
+    const auto& data = request.data();
+
+    if (data.size() == hash_size)
+    {
+        hash_digest hash;
+        std::copy(data.begin(), data.end(), hash.begin());
+
+        // The transaction may be confirmed or unconfirmed.
+        node.chain().fetch_transaction(hash, false,
+            std::bind(resolve_prevouts,
+                std::ref(node), _1, _2, request, handler));
+        return;
+    }
+
+    const auto tx = std::make_shared<bc::message::transaction>();
+
+    if (!tx->from_data(version, data))
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    resolve_prevouts(node, error::success, tx, request, handler);
+}
+
+// Each parent is fetched concurrently from the chain or the pool, and the
+// response is sent from a dispatch thread once all have completed.
+void transaction_pool::resolve_prevouts(server_node& node, const code& ec,
+    transaction_const_ptr tx, const message& request, send_handler handler)
+{
+    if (ec)
+    {
+        handler(message(request, ec));
+        return;
+    }
+
+    // A coinbase input has no previous output.
+    if (tx->is_coinbase())
+    {
+        handler(message(request, error::not_found));
+        return;
+    }
+
+    const auto& inputs = tx->inputs();
+    const auto query = std::make_shared<prevout_query>();
+    query->tx = tx;
+    query->prevouts.resize(inputs.size());
+
+    const auto complete = synchronize(
+        std::bind(prevouts_resolved,
+            _1, query, request, handler),
+        inputs.size(), "fetch_prevouts");
+
+    for (size_t slot = 0; slot < inputs.size(); ++slot)
+        node.query_dispatch().concurrent(fetch_prevout,
+            std::ref(node), slot, query, complete);
+}
+
+void transaction_pool::fetch_prevout(server_node& node, size_t slot,
+    query_ptr query, result_handler complete)
+{
+    const auto& hash = query->tx->inputs()[slot].previous_output().hash();
+
+    node.chain().fetch_transaction(hash, false,
+        std::bind(handle_prevout,
+            _1, _2, _3, _4, slot, query, complete));
+}
+
+void transaction_pool::handle_prevout(const code& ec,
+    transaction_const_ptr tx, size_t height, size_t position, size_t slot,
+    query_ptr query, result_handler complete)
+{
+    if (ec)
+    {
+        complete(ec);
+        return;
+    }
+
+    const auto index = query->tx->inputs()[slot].previous_output().index();
+
+    if (index >= tx->outputs().size())
+    {
+        complete(error::not_found);
+        return;
+    }
+
+    const auto& output = tx->outputs()[index];
+    const auto unconfirmed =
+        position == database::transaction_database::unconfirmed;
+
+    // Each lookup writes a distinct element of the preallocated list.
+    // Unconfirmed previous outputs are reported at zero height.
+    query->prevouts[slot] =
+    {
+        output.value(),
+        unconfirmed ? 0 : height,
+        output.script()
+    };
+
+    complete(error::success);
+}
+
+void transaction_pool::prevouts_resolved(const code& ec, query_ptr query,
+    const message& request, send_handler handler)
+{
+    if (ec)
+    {
+        handler(message(request, ec));
+        return;
+    }
+
+    uint64_t value = 0;
+    auto size = code_size + sizeof(uint64_t) + sizeof(uint32_t);
+
+    for (const auto& prevout: query->prevouts)
+    {
+        value = ceiling_add(value, prevout.value);
+        size += sizeof(uint64_t) + sizeof(uint32_t) +
+            prevout.script.serialized_size(true);
+    }
+
+    // An overspending transaction is reported with zero fee.
+    const auto fee = floor_subtract(value, query->tx->total_output_value());
+
+    // [ code:4 ]
+    // [ fee:8 ]
+    // [ count:4 ]
+    // [[ value:8 ][ height:4 ][ script_size:varint ][ script ]...]
+    data_chunk result(size);
+    auto serial = make_unsafe_serializer(result.begin());
+    serial.write_error_code(error::success);
+    serial.write_8_bytes_little_endian(fee);
+    serial.write_4_bytes_little_endian(
+        static_cast<uint32_t>(query->prevouts.size()));
+
+    for (const auto& prevout: query->prevouts)
+    {
+        BITCOIN_ASSERT(prevout.height <= max_uint32);
+        serial.write_8_bytes_little_endian(prevout.value);
+        serial.write_4_bytes_little_endian(
+            static_cast<uint32_t>(prevout.height));
+        serial.write_bytes(prevout.script.to_data(true));
+    }
+
+    handler(message(request, result));
+}
+
+// The histogram is maintained as the pool changes, so is not computed here.
+void transaction_pool::fetch_fee_histogram(server_node& node,
+    const message& request, send_handler handler)
+{
+    if (!request.data().empty())
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // [ code:4 ]
+    // [ buckets:1 ]
+    // [[ rate:4 ][ transactions:4 ][ bytes:8 ]...]
+    const auto result = build_chunk(
+    {
+        message::to_bytes(error::success),
+        node.pool_fees().to_data()
+    });
+
+    handler(message(request, result));
+}
+
+// [ mode:1 ][ sequence:8 ]
+// The snapshot is of transactions seen since start, not yet confirmed, as
+// tracked by the status monitor. So it omits those pooled before start and
+// may include those since conflicted or evicted, until they expire.
+// Mode zero streams the transactions, mode one only their hashes and sizes.
+// The returned sequence counts pool acceptances, so a client that subscribes
+// to the transaction service before this query discards published
+// transactions found in the snapshot, and may later resume from the sequence.
+void transaction_pool::fetch_snapshot(server_node& node,
+    const message& request, send_handler handler)
+{
+    static constexpr uint8_t hashes_mode = 1;
+    const auto& data = request.data();
+
+    if (data.size() != sizeof(uint8_t) + sizeof(uint64_t))
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const auto mode = deserial.read_byte();
+    const auto from_sequence = deserial.read_8_bytes_little_endian();
+
+    if (mode > hashes_mode)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    status_monitor::pool_list entries;
+    const auto sequence = node.status().pool(from_sequence, entries);
+    const auto items = std::make_shared<std::vector<data_chunk>>(
+        entries.size());
+
+    if (mode == hashes_mode || entries.empty())
+    {
+        for (size_t slot = 0; slot < entries.size(); ++slot)
+            (*items)[slot] = build_chunk(
+            {
+                entries[slot].hash,
+                to_little_endian(entries[slot].size)
+            });
+
+        send_snapshot(sequence, *items, request, handler);
+        return;
+    }
+
+    const auto complete = synchronize(
+        std::bind(snapshot_fetched,
+            _1, sequence, items, request, handler),
+        entries.size(), "fetch_snapshot");
+
+    for (size_t slot = 0; slot < entries.size(); ++slot)
+        node.chain().fetch_transaction(entries[slot].hash, false,
+            std::bind(snapshot_item_fetched,
+                _1, _2, slot, items, complete));
+}
+
+void transaction_pool::snapshot_item_fetched(const code& ec,
+    transaction_ptr tx, size_t slot, items_ptr items, result_handler complete)
+{
+    static const auto version = bc::message::version::level::canonical;
+
+    // A transaction dropped since enumeration is omitted from the snapshot.
+    if (ec == error::not_found)
+    {
+        complete(error::success);
+        return;
+    }
+
+    if (ec)
+    {
+        complete(ec);
+        return;
+    }
+
+    const auto tx_data = tx->to_data(version);
+
+    // Each lookup writes a distinct element of the preallocated list.
+    (*items)[slot] = build_chunk(
+    {
+        to_little_endian(static_cast<uint32_t>(tx_data.size())),
+        tx_data
+    });
+
+    complete(error::success);
+}
+
+void transaction_pool::snapshot_fetched(const code& ec, uint64_t sequence,
+    items_ptr items, const message& request, send_handler handler)
+{
+    if (ec)
+    {
+        handler(message(request, ec));
+        return;
+    }
+
+    send_snapshot(sequence, *items, request, handler);
+}
+
+// The snapshot is sent as a sequence of bounded responses to the one
+// request, each with the number of responses that follow it.
+void transaction_pool::send_snapshot(uint64_t sequence,
+    const std::vector<data_chunk>& items, const message& request,
+    send_handler handler)
+{
+    static constexpr size_t frame_size = 512 * 1024;
+    typedef std::pair<size_t, size_t> range;
+
+    // Each frame holds at least one item, so a large transaction may exceed.
+    std::vector<range> frames{ { 0, 0 } };
+    size_t bytes = 0;
+
+    for (size_t slot = 0; slot < items.size(); ++slot)
+    {
+        const auto size = items[slot].size();
+
+        if (bytes > 0 && bytes + size > frame_size)
+        {
+            frames.push_back({ slot, slot });
+            bytes = 0;
+        }
+
+        frames.back().second = slot + 1;
+        bytes += size;
+    }
+
+    BITCOIN_ASSERT(frames.size() <= max_uint32);
+    auto remaining = static_cast<uint32_t>(frames.size());
+
+    for (const auto& frame: frames)
+    {
+        uint32_t count = 0;
+        data_chunk entries;
+
+        for (auto slot = frame.first; slot < frame.second; ++slot)
+        {
+            // Omitted transactions leave an empty item.
+            if (items[slot].empty())
+                continue;
+
+            extend_data(entries, items[slot]);
+            ++count;
+        }
+
+        // [ code:4 ]
+        // [ sequence:8 ]
+        // [ remaining:4 ]
+        // [ count:4 ]
+        // [[ hash:32 ][ size:4 ]...] or [[ size:4 ][ tx ]...]
+        const auto result = build_chunk(
+        {
+            message::to_bytes(error::success),
+            to_little_endian(sequence),
+            to_little_endian(--remaining),
+            to_little_endian(count),
+            entries
+        });
+
+        handler(message(request, result));
+    }
+}
+
 // Save to tx pool and announce to all connected peers.
 // FUTURE: conditionally subscribe to penetration notifications.
 void transaction_pool::broadcast(server_node& node, const message& request,
     send_handler handler)
 {
     static const auto version = bc::message::version::level::canonical;
+
+    // The payload hash is the transaction hash if the payload is valid.
+    const auto key = bitcoin_hash(request.data());
+    code verdict;
+
+    // A repeated broadcast is answered without entering the organizer.
+    if (node.broadcasts().find(key, verdict))
+    {
+        handler(message(request, verdict));
+        return;
+    }
+
     const auto tx = std::make_shared<bc::message::transaction>();
 
     if (!tx->from_data(version, request.data()))
@@ -69,16 +500,212 @@ void transaction_pool::broadcast(server_node& node, const message& request,
     // This call is async but blocks on other organizations until started.
     // Subscribed channels will pick up and announce via tx inventory to peers.
     node.chain().organize(tx,
-        std::bind(handle_broadcast, _1, request, handler));
+        std::bind(handle_broadcast,
+            std::ref(node), _1, key, request, handler));
 }
 
-void transaction_pool::handle_broadcast(const code& ec, const message& request,
-    send_handler handler)
+// Failures are not cached, as a missing parent may yet be broadcast.
+void transaction_pool::handle_broadcast(server_node& node, const code& ec,
+    const hash_digest& key, const message& request, send_handler handler)
 {
+    if (!ec)
+        node.broadcasts().store(key, ec);
+
     // Returns validation error or error::success.
     handler(message(request, ec));
 }
 
+// [ count:4 ][[ size:4 ][ tx ]...]
+// Each result is returned in request order, the batch code is success.
+void transaction_pool::broadcast_transactions(server_node& node,
+    const message& request, send_handler handler)
+{
+    const auto& data = request.data();
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const size_t count = deserial.read_4_bytes_little_endian();
+
+    if (!deserial || count == 0 || count > query_batch_limit)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    data_stack payloads;
+    payloads.reserve(count);
+
+    for (size_t slot = 0; slot < count && deserial; ++slot)
+        payloads.push_back(deserial.read_bytes(
+            deserial.read_4_bytes_little_endian()));
+
+    if (!deserial || !deserial.is_exhausted())
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    const auto batch = std::make_shared<broadcast_batch>();
+    batch->txs.resize(count);
+    batch->codes.resize(count, error::success);
+
+    const auto complete = synchronize(
+        std::bind(batch_checked,
+            std::ref(node), _1, batch, request, handler),
+        count, "broadcast_transactions");
+
+    // Deserialization and context free checks are performed concurrently.
+    // Organization and the response then complete off the worker thread, and
+    // the response is routed back by the query worker.
+    for (size_t slot = 0; slot < count; ++slot)
+        node.query_dispatch().concurrent(check_batch_item,
+            std::move(payloads[slot]), slot, batch, complete);
+}
+
+void transaction_pool::check_batch_item(const data_chunk& payload,
+    size_t slot, batch_ptr batch, result_handler complete)
+{
+    static const auto version = bc::message::version::level::canonical;
+    const auto tx = std::make_shared<bc::message::transaction>();
+
+    // Each check writes a distinct element of the preallocated lists.
+    if (!tx->from_data(version, payload))
+    {
+        batch->codes[slot] = error::bad_stream;
+    }
+    else
+    {
+        const auto ec = tx->check();
+
+        if (ec)
+            batch->codes[slot] = ec;
+        else
+            batch->txs[slot] = tx;
+    }
+
+    complete(error::success);
+}
+
+// Order the checked transactions so that parents in the batch precede
+// their children, otherwise retaining request order.
+void transaction_pool::batch_checked(server_node& node, const code& ec,
+    batch_ptr batch, const message& request, send_handler handler)
+{
+    if (ec)
+    {
+        handler(message(request, ec));
+        return;
+    }
+
+    const auto count = batch->txs.size();
+    std::unordered_map<hash_digest, size_t> slots;
+
+    for (size_t slot = 0; slot < count; ++slot)
+        if (batch->txs[slot])
+            slots.emplace(batch->txs[slot]->hash(), slot);
+
+    std::vector<size_t> parents(count, 0);
+    std::vector<std::vector<size_t>> children(count);
+
+    for (size_t slot = 0; slot < count; ++slot)
+    {
+        if (!batch->txs[slot])
+            continue;
+
+        for (const auto& input: batch->txs[slot]->inputs())
+        {
+            const auto parent = slots.find(input.previous_output().hash());
+
+            if (parent != slots.end() && parent->second != slot)
+            {
+                ++parents[slot];
+                children[parent->second].push_back(slot);
+            }
+        }
+    }
+
+    std::vector<size_t> ready;
+
+    for (auto slot = count; slot > 0; --slot)
+        if (batch->txs[slot - 1] && parents[slot - 1] == 0)
+            ready.push_back(slot - 1);
+
+    while (!ready.empty())
+    {
+        const auto slot = ready.back();
+        ready.pop_back();
+        batch->order.push_back(slot);
+
+        for (auto child = children[slot].rbegin();
+            child != children[slot].rend(); ++child)
+            if (--parents[*child] == 0)
+                ready.push_back(*child);
+    }
+
+    organize_batch_item(node, 0, batch, request, handler);
+}
+
+// Transactions are organized in turn so each sees its parents in the pool.
+void transaction_pool::organize_batch_item(server_node& node, size_t index,
+    batch_ptr batch, const message& request, send_handler handler)
+{
+    if (index == batch->order.size())
+    {
+        const auto count = batch->codes.size();
+
+        // [ code:4 ]
+        // [ count:4 ]
+        // [[ code:4 ]...]
+        data_chunk result(code_size + sizeof(uint32_t) + code_size * count);
+        auto serial = make_unsafe_serializer(result.begin());
+        serial.write_error_code(error::success);
+        serial.write_4_bytes_little_endian(static_cast<uint32_t>(count));
+
+        for (const auto& ec: batch->codes)
+            serial.write_error_code(ec);
+
+        handler(message(request, result));
+        return;
+    }
+
+    const auto tx = batch->txs[batch->order[index]];
+    const auto tx_hash = tx->hash();
+    code verdict;
+
+    // A repeated transaction is not organized again.
+    if (node.broadcasts().find(tx_hash, verdict))
+    {
+        batch_item_organized(node, error::success, index, batch, request,
+            handler);
+        return;
+    }
+
+    // Organize into our chain.
+    tx->validation.simulate = false;
+
+    // This call is async but blocks on other organizations until started.
+    node.chain().organize(tx,
+        std::bind(batch_item_organized,
+            std::ref(node), _1, index, batch, request, handler));
+}
+
+void transaction_pool::batch_item_organized(server_node& node,
+    const code& ec, size_t index, batch_ptr batch, const message& request,
+    send_handler handler)
+{
+    if (ec == error::service_stopped)
+    {
+        handler(message(request, ec));
+        return;
+    }
+
+    const auto slot = batch->order[index];
+    batch->codes[slot] = ec;
+
+    if (!ec)
+        node.broadcasts().store(batch->txs[slot]->hash(), ec);
+
+    organize_batch_item(node, index + 1, batch, request, handler);
+}
+
 void transaction_pool::validate2(server_node& node, const message& request,
     send_handler handler)
 {
@@ -94,6 +721,8 @@ void transaction_pool::validate2(server_node& node, const message& request,
     // Simulate organization into our chain.
     tx->validation.simulate = true;
 
+    // A verdict depends upon the pool, which changes without notification
+    // of the transactions it drops, so it is not cached.
     // This call is async but blocks on other organizations until started.
     node.chain().organize(tx,
         std::bind(handle_validated2, _1, request, handler));
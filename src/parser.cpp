@@ -479,16 +479,101 @@ options_metadata parser::load_settings()
         value<uint32_t>(&configured.server.heartbeat_interval_seconds),
         "The heartbeat interval, defaults to 5 (0 disables service)."
     )
+    (
+        "server.extended_heartbeat",
+        value<bool>(&configured.server.extended_heartbeat),
+        "Publish chain tip and server load with the heartbeat, defaults to false."
+    )
     (
         "server.block_service_enabled",
         value<bool>(&configured.server.block_service_enabled),
         "Enable the block publishing service, defaults to true."
     )
+    (
+        "server.publish_reorganizations",
+        value<bool>(&configured.server.publish_reorganizations),
+        "Publish reorganization events with published blocks, defaults to false."
+    )
     (
         "server.transaction_service_enabled",
         value<bool>(&configured.server.transaction_service_enabled),
         "Enable the transaction publishing service, defaults to true."
     )
+    (
+        "server.transaction_batch_milliseconds",
+        value<uint32_t>(&configured.server.transaction_batch_milliseconds),
+        "The window for batching published transactions, defaults to 0 (disabled)."
+    )
+    (
+        "server.transaction_batch_size",
+        value<uint32_t>(&configured.server.transaction_batch_size),
+        "The maximum number of transactions in a published batch, defaults to 100."
+    )
+    (
+        "server.address_index_enabled",
+        value<bool>(&configured.server.address_index_enabled),
+        "Maintain the address balance and unspent output index from index_start_height, defaults to false."
+    )
+    (
+        "server.filter_index_enabled",
+        value<bool>(&configured.server.filter_index_enabled),
+        "Maintain BIP158 compact block filters from index_start_height, defaults to false."
+    )
+    (
+        "server.header_index_enabled",
+        value<bool>(&configured.server.header_index_enabled),
+        "Hold all block headers in memory for header and time queries, defaults to false."
+    )
+    (
+        "server.mempool_index_enabled",
+        value<bool>(&configured.server.mempool_index_enabled),
+        "Maintain the unconfirmed history of addresses, defaults to false."
+    )
+    (
+        "server.unconfirmed_expiration_hours",
+        value<uint32_t>(&configured.server.unconfirmed_expiration_hours),
+        "The age in hours at which an unconfirmed transaction is dropped from the mempool index and pool status, defaults to 336."
+    )
+    (
+        "server.script_index_enabled",
+        value<bool>(&configured.server.script_index_enabled),
+        "Maintain the script hash history and balance index from index_start_height, defaults to false."
+    )
+    (
+        "server.fee_estimator_enabled",
+        value<bool>(&configured.server.fee_estimator_enabled),
+        "Estimate fee rates from pool confirmation delays, defaults to true."
+    )
+    (
+        "server.fee_estimator_save_blocks",
+        value<uint32_t>(&configured.server.fee_estimator_save_blocks),
+        "The number of blocks between saves of the fee estimator statistics, which are also saved on stop, defaults to 6 (0 disables)."
+    )
+    (
+        "server.merkle_cache_blocks",
+        value<uint32_t>(&configured.server.merkle_cache_blocks),
+        "The number of block merkle trees cached for proofs, defaults to 32 (0 disables)."
+    )
+    (
+        "server.broadcast_cache_seconds",
+        value<uint32_t>(&configured.server.broadcast_cache_seconds),
+        "The window in which a repeated transaction broadcast is answered from its prior acceptance, defaults to 60 (0 disables)."
+    )
+    (
+        "server.broadcast_cache_entries",
+        value<uint32_t>(&configured.server.broadcast_cache_entries),
+        "The maximum number of broadcast verdicts cached, defaults to 10000 (0 disables)."
+    )
+    (
+        "server.validation_cache_seconds",
+        value<uint32_t>(&configured.server.validation_cache_seconds),
+        "The window in which a repeated valid block payload is answered without validation at the same chain top, defaults to 10 (0 disables)."
+    )
+    (
+        "server.validation_cache_entries",
+        value<uint32_t>(&configured.server.validation_cache_entries),
+        "The maximum number of validation verdicts cached, defaults to 1000 (0 disables)."
+    )
     (
         "server.public_query_endpoint",
         value<endpoint>(&configured.server.public_query_endpoint),
@@ -37,6 +37,20 @@ using namespace bc::protocol;
 server_node::server_node(const configuration& configuration)
   : full_node(configuration),
     configuration_(configuration),
+    query_dispatch_(thread_pool(), "query_dispatch"),
+    status_(*this, configuration.server.unconfirmed_expiration()),
+    pool_fees_(*this, configuration.server.unconfirmed_expiration()),
+    fee_estimates_(*this, configuration),
+    addresses_(*this, configuration),
+    filters_(*this, configuration),
+    headers_(*this, configuration),
+    mempool_(*this, configuration.server.unconfirmed_expiration()),
+    scripts_(*this, configuration),
+    merkle_trees_(*this, configuration.server.merkle_cache_blocks),
+    broadcasts_(*this, configuration.server.broadcast_cache_entries,
+        configuration.server.broadcast_cache_lifetime()),
+    validations_(*this, configuration.server.validation_cache_entries,
+        configuration.server.validation_cache_lifetime()),
     authenticator_(*this),
     secure_query_service_(authenticator_, *this, true),
     public_query_service_(authenticator_, *this, false),
@@ -65,6 +79,78 @@ const settings& server_node::server_settings() const
     return configuration_.server;
 }
 
+dispatcher& server_node::query_dispatch()
+{
+    return query_dispatch_;
+}
+
+status_monitor& server_node::status()
+{
+    return status_;
+}
+
+const fee_histogram& server_node::pool_fees() const
+{
+    return pool_fees_;
+}
+
+const fee_estimator& server_node::fee_estimates() const
+{
+    return fee_estimates_;
+}
+
+const relay_monitor& server_node::block_relay(bool secure) const
+{
+    return secure ? secure_block_service_.monitor() :
+        public_block_service_.monitor();
+}
+
+const relay_monitor& server_node::transaction_relay(bool secure) const
+{
+    return secure ? secure_transaction_service_.monitor() :
+        public_transaction_service_.monitor();
+}
+
+const address_index& server_node::addresses() const
+{
+    return addresses_;
+}
+
+const filter_index& server_node::filters() const
+{
+    return filters_;
+}
+
+const header_index& server_node::headers() const
+{
+    return headers_;
+}
+
+const mempool_index& server_node::mempool() const
+{
+    return mempool_;
+}
+
+const script_index& server_node::scripts() const
+{
+    return scripts_;
+}
+
+merkle_cache& server_node::merkle_trees()
+{
+    return merkle_trees_;
+}
+
+verdict_cache& server_node::broadcasts()
+{
+    return broadcasts_;
+}
+
+verdict_cache& server_node::validations()
+{
+    return validations_;
+}
+
 // Run sequence.
 // ----------------------------------------------------------------------------
 
@@ -106,7 +192,9 @@ void server_node::handle_running(const code& ec, result_handler handler)
 bool server_node::stop()
 {
     // Suspend new work last so we can use work to clear subscribers.
-    return authenticator_.stop() && full_node::stop();
+    // The fee statistics are saved once the node no longer notifies.
+    return authenticator_.stop() && full_node::stop() &&
+        fee_estimates_.stop();
 }
 
 // This must be called from the thread that constructed this class (see join).
@@ -130,6 +218,29 @@ code server_node::subscribe_address(const route& reply_to, uint32_t id,
             prefix_filter, unsubscribe);
 }
 
+// Subscribe (or unsubscribe) to output script hash notifications.
+code server_node::subscribe_script(const route& reply_to, uint32_t id,
+    const hash_digest& script_hash, bool unsubscribe)
+{
+    return reply_to.secure ?
+        secure_notification_worker_.subscribe_script(reply_to, id,
+            script_hash, unsubscribe) :
+        public_notification_worker_.subscribe_script(reply_to, id,
+            script_hash, unsubscribe);
+}
+
+// Subscribe (or unsubscribe) to transaction confirmation notifications.
+code server_node::subscribe_confirmations(const route& reply_to, uint32_t id,
+    const hash_digest& tx_hash, const std::vector<uint32_t>& depths,
+    bool unsubscribe)
+{
+    return reply_to.secure ?
+        secure_notification_worker_.subscribe_confirmations(reply_to, id,
+            tx_hash, depths, unsubscribe) :
+        public_notification_worker_.subscribe_confirmations(reply_to, id,
+            tx_hash, depths, unsubscribe);
+}
+
 ////// Subscribe to transaction penetration notifications.
 ////void server_node::subscribe_penetration(const route& reply_to, uint32_t id,
 ////    const hash_digest& tx_hash)
@@ -148,11 +259,59 @@ code server_node::subscribe_address(const route& reply_to, uint32_t id,
 bool server_node::start_services()
 {
     return
+        start_status() && start_indexes() && start_caches() &&
         start_authenticator() && start_query_services() &&
         start_heartbeat_services() && start_block_services() &&
         start_transaction_services();
 }
 
+bool server_node::start_status()
+{
+    // The monitors are passive and inexpensive so they are always started.
+    // The fee estimator is optional as it writes its statistics to disk.
+    return status_.start() && pool_fees_.start() &&
+        (!fee_estimates_.enabled() || fee_estimates_.start());
+}
+
+bool server_node::start_indexes()
+{
+    const auto& settings = configuration_.server;
+
+    // Indexes build in the background and answer queries once populated.
+    if (settings.address_index_enabled && !addresses_.start())
+        return false;
+
+    if (settings.filter_index_enabled && !filters_.start())
+        return false;
+
+    if (settings.header_index_enabled && !headers_.start())
+        return false;
+
+    if (settings.mempool_index_enabled && !mempool_.start())
+        return false;
+
+    if (settings.script_index_enabled && !scripts_.start())
+        return false;
+
+    return true;
+}
+
+bool server_node::start_caches()
+{
+    const auto& settings = configuration_.server;
+
+    if (settings.merkle_cache_blocks > 0 && !merkle_trees_.start())
+        return false;
+
+    if (broadcasts_.enabled() && !broadcasts_.start())
+        return false;
+
+    if (validations_.enabled() && !validations_.start())
+        return false;
+
+    return true;
+}
+
 bool server_node::start_authenticator()
 {
     const auto& settings = configuration_.server;
@@ -77,9 +77,22 @@ void block_service::work()
     if (!started(bind(xpub, xsub)))
         return;
 
-    // TODO: tap in to failure conditions, such as high water.
+    zmq::poller poller;
+    poller.add(xpub);
+    poller.add(xsub);
+
     // Relay messages between subscriber and publisher (blocks on context).
-    relay(xpub, xsub);
+    // Each message is accounted so that slow consumers may be detected.
+    while (!poller.terminated() && !stopped())
+    {
+        const auto ready = poller.wait();
+
+        if (ready.contains(xsub.id()))
+            forward(xsub, xpub, poller);
+
+        if (ready.contains(xpub.id()))
+            subscribe(xpub, xsub);
+    }
 
     // Unbind the sockets and exit this thread.
     finished(unbind(xpub, xsub));
@@ -142,12 +155,56 @@ bool block_service::unbind(zmq::socket& xpub, zmq::socket& xsub)
     return service_stop && worker_stop;
 }
 
+// Relay.
+//-----------------------------------------------------------------------------
+
+void block_service::forward(zmq::socket& xsub, zmq::socket& xpub,
+    zmq::poller& poller)
+{
+    const auto ec = monitor_.forward(xsub, xpub);
+
+    if (ec == error::service_stopped)
+        return;
+
+    if (ec)
+    {
+        const auto security = secure_ ? "secure" : "public";
+        LOG_WARNING(LOG_SERVER)
+            << "Failed to relay " << security << " block: " << ec.message();
+    }
+
+    // A worker message already queued indicates that the relay is behind.
+    monitor_.backlog(poller.wait(0).contains(xsub.id()));
+}
+
+void block_service::subscribe(zmq::socket& xpub, zmq::socket& xsub)
+{
+    const auto ec = monitor_.subscribe(xpub, xsub);
+
+    if (ec && ec != error::service_stopped)
+    {
+        const auto security = secure_ ? "secure" : "public";
+        LOG_WARNING(LOG_SERVER)
+            << "Failed to relay " << security << " block subscription: "
+            << ec.message();
+    }
+}
+
+const relay_monitor& block_service::monitor() const
+{
+    return monitor_;
+}
+
 // Publish (integral worker).
 // ----------------------------------------------------------------------------
 
 bool block_service::handle_reorganization(const code& ec, size_t fork_height,
-    block_const_ptr_list_const_ptr new_blocks, block_const_ptr_list_const_ptr)
+    block_const_ptr_list_const_ptr new_blocks,
+    block_const_ptr_list_const_ptr old_blocks)
 {
+    // Publication latency is measured from notification.
+    const auto entry = asio::steady_clock::now();
+
     if (stopped() || ec == error::service_stopped)
         return false;
 
@@ -161,12 +218,14 @@ bool block_service::handle_reorganization(const code& ec, size_t fork_height,
     }
 
     // Blockchain height is 64 bit but obelisk protocol is 32 bit.
-    publish_blocks(safe_unsigned<uint32_t>(fork_height), new_blocks);
+    publish_blocks(safe_unsigned<uint32_t>(fork_height), new_blocks,
+        old_blocks, entry);
     return true;
 }
 
 void block_service::publish_blocks(uint32_t fork_height,
-    block_const_ptr_list_const_ptr blocks)
+    block_const_ptr_list_const_ptr blocks,
+    block_const_ptr_list_const_ptr old_blocks, const asio::time_point& entry)
 {
     if (stopped())
         return;
@@ -191,12 +250,68 @@ void block_service::publish_blocks(uint32_t fork_height,
         return;
     }
 
+    // The event precedes its blocks so that consumers may roll back first.
+    if (settings_.publish_reorganizations)
+        publish_reorganization(publisher, fork_height, blocks, old_blocks,
+            entry);
+
     BITCOIN_ASSERT(blocks->size() <= max_uint32);
     BITCOIN_ASSERT(fork_height < max_uint32 - blocks->size());
     auto height = fork_height;
 
     for (const auto block: *blocks)
-        publish_block(publisher, height++, block);
+        publish_block(publisher, height++, block, entry);
+}
+
+// [ fork_height:4 ]
+// [[ disconnected_hash:32 ]...]
+// [[ connected_hash:32 ]...]
+// The fork height is that of the last block common to both branches. Hashes
+// are ordered by ascending height. An event has three frames and is thereby
+// distinguished from a block publication, which has two.
+void block_service::publish_reorganization(zmq::socket& publisher,
+    uint32_t fork_height, block_const_ptr_list_const_ptr new_blocks,
+    block_const_ptr_list_const_ptr old_blocks, const asio::time_point& entry)
+{
+    if (stopped())
+        return;
+
+    const auto security = secure_ ? "secure" : "public";
+    data_chunk disconnected(hash_size * old_blocks->size());
+    data_chunk connected(hash_size * new_blocks->size());
+    auto old_serial = make_unsafe_serializer(disconnected.begin());
+    auto new_serial = make_unsafe_serializer(connected.begin());
+
+    for (const auto block: *old_blocks)
+        old_serial.write_hash(block->header().hash());
+
+    for (const auto block: *new_blocks)
+        new_serial.write_hash(block->header().hash());
+
+    zmq::message broadcast;
+    broadcast.enqueue_little_endian(fork_height);
+    broadcast.enqueue(disconnected);
+    broadcast.enqueue(connected);
+    monitor_.stamp(broadcast, entry);
+    const auto ec = publisher.send(broadcast);
+
+    if (ec == error::service_stopped)
+        return;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failed to publish " << security << " reorganization at ["
+            << fork_height << "] " << ec.message();
+        return;
+    }
+
+    // This isn't actually a request, should probably update settings.
+    if (verbose_)
+        LOG_DEBUG(LOG_SERVER)
+            << "Published " << security << " reorganization at ["
+            << fork_height << "] disconnecting " << old_blocks->size()
+            << " and connecting " << new_blocks->size() << " blocks.";
 }
 
 // [ height:4 ]
@@ -205,7 +320,7 @@ void block_service::publish_blocks(uint32_t fork_height,
 // The payload for block publication is delimited within the zeromq message.
 // This is required for compatability and inconsistent with query payloads.
 void block_service::publish_block(zmq::socket& publisher, uint32_t height,
-    block_const_ptr block)
+    block_const_ptr block, const asio::time_point& entry)
 {
     if (stopped())
         return;
@@ -215,6 +330,7 @@ void block_service::publish_block(zmq::socket& publisher, uint32_t height,
     zmq::message broadcast;
     broadcast.enqueue_little_endian(height);
     broadcast.enqueue(block->to_data(bc::message::version::level::canonical));
+    monitor_.stamp(broadcast, entry);
     const auto ec = publisher.send(broadcast);
 
     if (ec == error::service_stopped)
@@ -19,6 +19,7 @@
 #include <bitcoin/server/services/heartbeat_service.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/server_node.hpp>
@@ -28,6 +29,7 @@ namespace libbitcoin {
 namespace server {
 
 static const auto domain = "heartbeat";
+static constexpr uint8_t status_version = 1;
 
 using namespace bc::config;
 using namespace bc::protocol;
@@ -46,7 +48,10 @@ heartbeat_service::heartbeat_service(zmq::authenticator& authenticator,
     verbose_(node.network_settings().verbose),
     settings_(node.server_settings()),
     period_(to_milliseconds(settings_.heartbeat_interval_seconds)),
-    authenticator_(authenticator)
+    query_microseconds_(0),
+    sampled_(asio::steady_clock::now()),
+    authenticator_(authenticator),
+    node_(node)
 {
 }
 
@@ -129,6 +134,11 @@ void heartbeat_service::publish(uint32_t count, zmq::socket& publisher)
 
     zmq::message message;
     message.enqueue_little_endian(count);
+
+    // The status frame is opt-in, legacy clients read only the counter.
+    if (settings_.extended_heartbeat)
+        message.enqueue(status());
+
     auto ec = publisher.send(message);
 
     if (ec == error::service_stopped)
@@ -148,5 +158,51 @@ void heartbeat_service::publish(uint32_t count, zmq::socket& publisher)
             << "Published " << security << " heartbeat [" << count << "].";
 }
 
+// [ version:1 ]
+// [ height:4 ]
+// [ hash:32 ]
+// [ pool_size:4 ]
+// [ queries:4 ]
+// [ load:4 ]
+// Load is the mean number of outstanding queries per query worker, in
+// thousandths, over the period since the preceding heartbeat.
+data_chunk heartbeat_service::status()
+{
+    size_t height;
+    hash_digest hash;
+    auto& status = node_.status();
+    status.top(height, hash);
+
+    const auto now = asio::steady_clock::now();
+    const auto busy = status.query_microseconds();
+    const auto period = std::chrono::duration_cast<asio::microseconds>(
+        now - sampled_).count();
+
+    const uint64_t endpoints =
+        (settings_.server_private_key ? 1 : 0) +
+        (settings_.secure_only ? 0 : 1);
+    const auto workers = endpoints * settings_.query_workers;
+    const auto capacity = static_cast<uint64_t>(period) * workers;
+
+    // Little's law: busy time over elapsed time is the mean outstanding.
+    const auto load = capacity == 0 ? 0 :
+        ((busy - query_microseconds_) * 1000) / capacity;
+
+    query_microseconds_ = busy;
+    sampled_ = now;
+
+    // Blockchain height is 64 bit but obelisk protocol is 32 bit.
+    return build_chunk(
+    {
+        to_array(status_version),
+        to_little_endian(safe_unsigned<uint32_t>(height)),
+        hash,
+        to_little_endian(safe_unsigned<uint32_t>(status.pool_size())),
+        to_little_endian(safe_unsigned<uint32_t>(status.queries())),
+        to_little_endian(static_cast<uint32_t>(std::min(load,
+            static_cast<uint64_t>(max_uint32))))
+    });
+}
+
 } // namespace server
 } // namespace libbitcoin
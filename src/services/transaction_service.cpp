@@ -18,8 +18,12 @@
  */
 #include <bitcoin/server/services/transaction_service.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <utility>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/configuration.hpp>
 #include <bitcoin/server/server_node.hpp>
@@ -43,6 +47,10 @@ transaction_service::transaction_service(zmq::authenticator& authenticator,
     secure_(secure),
     verbose_(node.network_settings().verbose),
     settings_(node.server_settings()),
+    batch_window_(static_cast<int32_t>(std::min(
+        settings_.transaction_batch_milliseconds,
+        static_cast<uint32_t>(max_int32)))),
+    batch_limit_(std::max(settings_.transaction_batch_size, 1u)),
     authenticator_(authenticator),
     node_(node)
 {
@@ -76,9 +84,31 @@ void transaction_service::work()
     if (!started(bind(xpub, xsub)))
         return;
 
-    // TODO: tap in to failure conditions, such as high water.
+    zmq::poller poller;
+    poller.add(xpub);
+    poller.add(xsub);
+
     // Relay messages between subscriber and publisher (blocks on context).
-    relay(xpub, xsub);
+    // Each message is accounted so that slow consumers may be detected.
+    // When batching the poller timer also closes the publication window.
+    while (!poller.terminated() && !stopped())
+    {
+        const auto ready = batch_window_ > 0 ?
+            poller.wait(remaining_window()) : poller.wait();
+
+        if (ready.contains(xsub.id()))
+            forward(xsub, xpub, poller);
+
+        if (ready.contains(xpub.id()))
+            subscribe(xpub, xsub);
+
+        if (batch_window_ > 0)
+            publish_expired();
+    }
+
+    // An open batch is not discarded, but is sent directly to subscribers.
+    if (batch_window_ > 0)
+        publish_remaining(xpub);
 
     // Unbind the sockets and exit this thread.
     finished(unbind(xpub, xsub));
@@ -141,12 +171,55 @@ bool transaction_service::unbind(zmq::socket& xpub, zmq::socket& xsub)
     return service_stop && worker_stop;
 }
 
+// Relay.
+//-----------------------------------------------------------------------------
+
+void transaction_service::forward(zmq::socket& xsub, zmq::socket& xpub,
+    zmq::poller& poller)
+{
+    const auto ec = monitor_.forward(xsub, xpub);
+
+    if (ec == error::service_stopped)
+        return;
+
+    if (ec)
+    {
+        const auto security = secure_ ? "secure" : "public";
+        LOG_WARNING(LOG_SERVER)
+            << "Failed to relay " << security << " transaction: " << ec.message();
+    }
+
+    // A worker message already queued indicates that the relay is behind.
+    monitor_.backlog(poller.wait(0).contains(xsub.id()));
+}
+
+void transaction_service::subscribe(zmq::socket& xpub, zmq::socket& xsub)
+{
+    const auto ec = monitor_.subscribe(xpub, xsub);
+
+    if (ec && ec != error::service_stopped)
+    {
+        const auto security = secure_ ? "secure" : "public";
+        LOG_WARNING(LOG_SERVER)
+            << "Failed to relay " << security << " transaction subscription: "
+            << ec.message();
+    }
+}
+
+const relay_monitor& transaction_service::monitor() const
+{
+    return monitor_;
+}
+
 // Publish (integral worker).
 // ----------------------------------------------------------------------------
 
 bool transaction_service::handle_transaction(const code& ec,
     transaction_const_ptr tx)
 {
+    // Publication latency is measured from notification.
+    const auto entry = asio::steady_clock::now();
+
     if (stopped() || ec == error::service_stopped)
         return false;
 
@@ -159,12 +232,129 @@ bool transaction_service::handle_transaction(const code& ec,
         return true;
     }
 
-    publish_transaction(tx);
+    if (batch_window_ == 0)
+    {
+        publish_transaction(tx, entry);
+        return true;
+    }
+
+    transaction_const_ptr_list batch;
+    asio::time_point opened;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    batch_mutex_.lock();
+
+    if (batch_.empty())
+        batch_opened_ = entry;
+
+    batch_.push_back(tx);
+
+    // Close the batch early if it has reached the size limit.
+    if (batch_.size() >= batch_limit_)
+    {
+        std::swap(batch, batch_);
+        opened = batch_opened_;
+    }
+
+    batch_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (!batch.empty())
+        publish_transactions(batch, opened);
+
     return true;
 }
 
+// Called from the relay thread upon each poller wake.
+void transaction_service::publish_expired()
+{
+    const auto window = asio::milliseconds(batch_window_);
+    transaction_const_ptr_list batch;
+    asio::time_point opened;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    batch_mutex_.lock();
+
+    if (!batch_.empty() &&
+        asio::steady_clock::now() - batch_opened_ >= window)
+    {
+        std::swap(batch, batch_);
+        opened = batch_opened_;
+    }
+
+    batch_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (!batch.empty())
+        publish_transactions(batch, opened);
+}
+
+// The time until the open batch expires, or the full window if none is open.
+// The poller wait is bounded by this, so a batch is not held beyond its window.
+int32_t transaction_service::remaining_window()
+{
+    const auto window = asio::milliseconds(batch_window_);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(batch_mutex_);
+
+    if (batch_.empty())
+        return batch_window_;
+
+    const auto elapsed = asio::steady_clock::now() - batch_opened_;
+
+    if (elapsed >= window)
+        return 0;
+
+    // Round up so that the wait does not end just short of expiry.
+    const auto remaining = std::chrono::duration_cast<asio::milliseconds>(
+        window - elapsed);
+    return static_cast<int32_t>(remaining.count()) + 1;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Called from the relay thread upon stop, as the worker endpoint is no longer
+// relayed. The batch is untimed, as it does not pass through the relay.
+void transaction_service::publish_remaining(zmq::socket& xpub)
+{
+    transaction_const_ptr_list batch;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    batch_mutex_.lock();
+    std::swap(batch, batch_);
+    batch_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (batch.empty())
+        return;
+
+    BITCOIN_ASSERT(batch.size() <= max_uint32);
+    const auto count = static_cast<uint32_t>(batch.size());
+
+    zmq::message broadcast;
+    broadcast.enqueue_little_endian(count);
+
+    for (const auto tx: batch)
+        broadcast.enqueue(tx->to_data(bc::message::version::level::canonical));
+
+    const auto ec = xpub.send(broadcast);
+
+    if (ec && ec != error::service_stopped)
+    {
+        const auto security = secure_ ? "secure" : "public";
+        LOG_WARNING(LOG_SERVER)
+            << "Failed to publish " << security << " batch of " << count
+            << " transactions on stop " << ec.message();
+    }
+}
+
 // [ tx... ]
-void transaction_service::publish_transaction(transaction_const_ptr tx)
+void transaction_service::publish_transaction(transaction_const_ptr tx,
+    const asio::time_point& entry)
 {
     if (stopped())
         return;
@@ -194,6 +384,7 @@ void transaction_service::publish_transaction(transaction_const_ptr tx)
 
     zmq::message broadcast;
     broadcast.enqueue(tx->to_data(bc::message::version::level::canonical));
+    monitor_.stamp(broadcast, entry);
     ec = publisher.send(broadcast);
 
     if (ec == error::service_stopped)
@@ -214,5 +405,69 @@ void transaction_service::publish_transaction(transaction_const_ptr tx)
             << encode_hash(tx->hash()) << "]";
 }
 
+// [ count:4 ]
+// [ tx... ]...
+// Each transaction is a distinct frame of the one multipart message.
+// Latency is measured from the notification of the first transaction, and
+// serialization from its start, excluding the wait for the batch to close.
+void transaction_service::publish_transactions(
+    const transaction_const_ptr_list& batch, const asio::time_point& entry)
+{
+    if (stopped())
+        return;
+
+    const auto security = secure_ ? "secure" : "public";
+    const auto& endpoint = secure_ ? transaction_service::secure_worker :
+        transaction_service::public_worker;
+
+    // One connection is made for the batch, not for each transaction.
+    zmq::socket publisher(authenticator_, zmq::socket::role::publisher);
+    auto ec = publisher.connect(endpoint);
+
+    if (ec == error::service_stopped)
+        return;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failed to connect " << security << " transaction worker: "
+            << ec.message();
+        return;
+    }
+
+    if (stopped())
+        return;
+
+    BITCOIN_ASSERT(batch.size() <= max_uint32);
+    const auto count = static_cast<uint32_t>(batch.size());
+
+    const auto serializing = asio::steady_clock::now();
+    zmq::message broadcast;
+    broadcast.enqueue_little_endian(count);
+
+    for (const auto tx: batch)
+        broadcast.enqueue(tx->to_data(bc::message::version::level::canonical));
+
+    monitor_.stamp(broadcast, entry, serializing);
+    ec = publisher.send(broadcast);
+
+    if (ec == error::service_stopped)
+        return;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failed to publish " << security << " batch of " << count
+            << " transactions " << ec.message();
+        return;
+    }
+
+    // This isn't actually a request, should probably update settings.
+    if (verbose_)
+        LOG_DEBUG(LOG_SERVER)
+            << "Published " << security << " batch of " << count
+            << " transactions.";
+}
+
 } // namespace server
 } // namespace libbitcoin
@@ -28,11 +28,28 @@ using namespace asio;
 settings::settings()
   : query_workers(1),
     heartbeat_interval_seconds(5),
+    extended_heartbeat(false),
     subscription_expiration_minutes(10),
     subscription_limit(0 /*100000000*/),
     secure_only(false),
     block_service_enabled(true),
+    publish_reorganizations(false),
     transaction_service_enabled(true),
+    transaction_batch_milliseconds(0),
+    transaction_batch_size(100),
+    address_index_enabled(false),
+    filter_index_enabled(false),
+    header_index_enabled(false),
+    mempool_index_enabled(false),
+    unconfirmed_expiration_hours(336),
+    script_index_enabled(false),
+    fee_estimator_enabled(true),
+    fee_estimator_save_blocks(6),
+    merkle_cache_blocks(32),
+    broadcast_cache_seconds(60),
+    broadcast_cache_entries(10000),
+    validation_cache_seconds(10),
+    validation_cache_entries(1000),
     public_query_endpoint("tcp://*:9091"),
     public_heartbeat_endpoint("tcp://*:9092"),
     public_block_endpoint("tcp://*:9093"),
@@ -60,5 +77,20 @@ duration settings::subscription_expiration() const
     return minutes(subscription_expiration_minutes);
 }
 
+duration settings::broadcast_cache_lifetime() const
+{
+    return seconds(broadcast_cache_seconds);
+}
+
+duration settings::validation_cache_lifetime() const
+{
+    return seconds(validation_cache_seconds);
+}
+
+duration settings::unconfirmed_expiration() const
+{
+    return hours(unconfirmed_expiration_hours);
+}
+
 } // namespace server
 } // namespace libbitcoin
@@ -0,0 +1,221 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/account_scanner.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/server_node.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+#define NAME "account_scanner"
+
+using namespace std::placeholders;
+using namespace bc::chain;
+using namespace bc::wallet;
+
+account_scanner::account_scanner(server_node& node, const hd_public& key,
+    uint8_t version, uint32_t gap_limit, size_t from_height)
+  : node_(node),
+    key_(key),
+    version_(version),
+    gap_limit_(gap_limit),
+    from_height_(from_height),
+    dispatch_(node.thread_pool(), NAME "_dispatch")
+{
+}
+
+void account_scanner::start(const std::vector<uint32_t>& chains,
+    scan_handler handler)
+{
+    scan_chain(chains, 0, handler);
+}
+
+// Scan.
+// ----------------------------------------------------------------------------
+
+// The chains are scanned in turn, which bounds the probes in flight to one
+// window of the gap limit regardless of the number of chains.
+void account_scanner::scan_chain(const chain_list& chains, size_t position,
+    scan_handler handler)
+{
+    if (position == chains.size())
+    {
+        handle_complete(error::success, handler);
+        return;
+    }
+
+    const auto chain = chains[position];
+    const auto chain_key = key_.derive_public(chain);
+
+    if (!chain_key)
+    {
+        handle_complete(error::bad_stream, handler);
+        return;
+    }
+
+    const auto complete =
+        std::bind(&account_scanner::handle_chain,
+            shared_from_this(), _1, chains, position, handler);
+
+    scan(chain_key, chain, 0, complete);
+}
+
+void account_scanner::handle_chain(const code& ec, const chain_list& chains,
+    size_t position, scan_handler handler)
+{
+    if (ec)
+    {
+        handle_complete(ec, handler);
+        return;
+    }
+
+    scan_chain(chains, position + 1, handler);
+}
+
+void account_scanner::scan(const hd_public& chain_key, uint32_t chain,
+    uint32_t first, result_handler complete)
+{
+    const auto window = std::make_shared<list>(gap_limit_);
+
+    const auto probed = synchronize(
+        std::bind(&account_scanner::handle_window,
+            shared_from_this(), _1, chain_key, chain, first, window,
+                complete), gap_limit_, NAME "_window");
+
+    for (uint32_t slot = 0; slot < gap_limit_; ++slot)
+        dispatch_.concurrent(&account_scanner::probe,
+            shared_from_this(), chain_key, chain, first + slot, window,
+                slot, probed);
+}
+
+// Derivation and history lookup are performed on the dispatch thread.
+void account_scanner::probe(const hd_public& chain_key, uint32_t chain,
+    uint32_t index, list_ptr window, size_t slot, result_handler complete)
+{
+    const auto child = chain_key.derive_public(index);
+
+    // Derivation fails with negligible probability, the index is skipped.
+    if (!child)
+    {
+        complete(error::success);
+        return;
+    }
+
+    auto& row = (*window)[slot];
+    row.chain = chain;
+    row.index = index;
+    row.hash = bitcoin_short_hash(child.point());
+
+    fetch_history(payment_address(row.hash, version_),
+        std::bind(&account_scanner::handle_history,
+            shared_from_this(), _1, _2, window, slot, complete));
+}
+
+void account_scanner::fetch_history(const payment_address& address,
+    history_handler handler)
+{
+    static constexpr size_t limit = 0;
+    node_.chain().fetch_history(address, limit, from_height_, handler);
+}
+
+void account_scanner::handle_history(const code& ec,
+    const history_compact::list& history, list_ptr window, size_t slot,
+    result_handler complete)
+{
+    if (ec)
+    {
+        complete(ec);
+        return;
+    }
+
+    // Each probe writes a distinct element of the preallocated window.
+    (*window)[slot].history = history;
+    complete(error::success);
+}
+
+// Scanning ends with the first window of unused addresses.
+void account_scanner::handle_window(const code& ec, const hd_public& chain_key,
+    uint32_t chain, uint32_t first, list_ptr window, result_handler complete)
+{
+    if (ec)
+    {
+        complete(ec);
+        return;
+    }
+
+    auto used = false;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    for (const auto& row: *window)
+    {
+        if (!row.history.empty())
+        {
+            used_.push_back(row);
+            used = true;
+        }
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Hardened indexes cannot be derived from a public key.
+    const auto next = static_cast<uint64_t>(first) + gap_limit_;
+
+    if (!used || next + gap_limit_ > hd_first_hardened_key)
+    {
+        complete(error::success);
+        return;
+    }
+
+    scan(chain_key, chain, static_cast<uint32_t>(next), complete);
+}
+
+void account_scanner::handle_complete(const code& ec, scan_handler handler)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    std::sort(used_.begin(), used_.end(),
+        [](const used_address& left, const used_address& right)
+        {
+            return left.chain < right.chain ||
+                (left.chain == right.chain && left.index < right.index);
+        });
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // All scans are complete, so the list is no longer written.
+    handler(ec, used_);
+}
+
+} // namespace server
+} // namespace libbitcoin
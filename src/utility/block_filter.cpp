@@ -0,0 +1,240 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/block_filter.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::chain;
+using namespace bc::machine;
+
+// SipHash-2-4.
+// ----------------------------------------------------------------------------
+
+static inline uint64_t rotate(uint64_t value, size_t bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline void sip_round(uint64_t& v0, uint64_t& v1, uint64_t& v2,
+    uint64_t& v3)
+{
+    v0 += v1; v1 = rotate(v1, 13); v1 ^= v0; v0 = rotate(v0, 32);
+    v2 += v3; v3 = rotate(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotate(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotate(v1, 17); v1 ^= v2; v2 = rotate(v2, 32);
+}
+
+static uint64_t read_word(const uint8_t* data, size_t size)
+{
+    uint64_t word = 0;
+
+    for (size_t byte = 0; byte < size; ++byte)
+        word |= static_cast<uint64_t>(data[byte]) << (8 * byte);
+
+    return word;
+}
+
+static uint64_t siphash(uint64_t k0, uint64_t k1, const data_chunk& message)
+{
+    uint64_t v0 = 0x736f6d6570736575 ^ k0;
+    uint64_t v1 = 0x646f72616e646f6d ^ k1;
+    uint64_t v2 = 0x6c7967656e657261 ^ k0;
+    uint64_t v3 = 0x7465646279746573 ^ k1;
+
+    const auto size = message.size();
+    const auto whole = size - size % 8;
+
+    for (size_t offset = 0; offset < whole; offset += 8)
+    {
+        const auto word = read_word(&message[offset], 8);
+        v3 ^= word;
+        sip_round(v0, v1, v2, v3);
+        sip_round(v0, v1, v2, v3);
+        v0 ^= word;
+    }
+
+    const auto last = (static_cast<uint64_t>(size & 0xff) << 56) |
+        (whole == size ? 0 : read_word(&message[whole], size - whole));
+
+    v3 ^= last;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    v0 ^= last;
+    v2 ^= 0xff;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+// Golomb-Rice coding.
+// ----------------------------------------------------------------------------
+
+// The high word of the 128 bit product, (value * range) >> 64.
+static uint64_t map_to_range(uint64_t value, uint64_t range)
+{
+    const auto value_high = value >> 32;
+    const auto value_low = value & 0xffffffff;
+    const auto range_high = range >> 32;
+    const auto range_low = range & 0xffffffff;
+
+    const auto high = value_high * range_high;
+    const auto middle1 = value_high * range_low;
+    const auto middle2 = value_low * range_high;
+    const auto low = value_low * range_low;
+
+    const auto carry = (low >> 32) + (middle1 & 0xffffffff) +
+        (middle2 & 0xffffffff);
+
+    return high + (middle1 >> 32) + (middle2 >> 32) + (carry >> 32);
+}
+
+// Bits are written from the most significant bit of each byte.
+class bit_writer
+{
+public:
+    bit_writer(data_chunk& out)
+      : out_(out), byte_(0), bits_(0)
+    {
+    }
+
+    // Write the low count bits of the value, most significant first.
+    void write(uint64_t value, size_t count)
+    {
+        while (count > 0)
+        {
+            const auto bit = (value >> --count) & 1;
+            byte_ = static_cast<uint8_t>((byte_ << 1) | bit);
+
+            if (++bits_ == byte_bits)
+            {
+                out_.push_back(byte_);
+                byte_ = 0;
+                bits_ = 0;
+            }
+        }
+    }
+
+    void flush()
+    {
+        if (bits_ == 0)
+            return;
+
+        out_.push_back(static_cast<uint8_t>(byte_ << (byte_bits - bits_)));
+        byte_ = 0;
+        bits_ = 0;
+    }
+
+private:
+    data_chunk& out_;
+    uint8_t byte_;
+    size_t bits_;
+};
+
+static void encode(bit_writer& writer, uint64_t delta)
+{
+    // The quotient is written in unary, terminated by a zero bit.
+    for (auto quotient = delta >> block_filter::rice_bits; quotient > 0;)
+    {
+        const auto ones = std::min(quotient, uint64_t(64));
+        writer.write(max_uint64, static_cast<size_t>(ones));
+        quotient -= ones;
+    }
+
+    writer.write(0, 1);
+    writer.write(delta, block_filter::rice_bits);
+}
+
+// Filter.
+// ----------------------------------------------------------------------------
+
+data_chunk block_filter::compute(const block& block,
+    const data_stack& prevout_scripts)
+{
+    data_stack items;
+
+    for (const auto& tx: block.transactions())
+    {
+        for (const auto& output: tx.outputs())
+        {
+            const auto script = output.script().to_data(false);
+
+            if (script.empty() ||
+                script.front() == static_cast<uint8_t>(opcode::return_))
+                continue;
+
+            items.push_back(script);
+        }
+    }
+
+    for (const auto& script: prevout_scripts)
+        if (!script.empty())
+            items.push_back(script);
+
+    std::sort(items.begin(), items.end());
+    items.erase(std::unique(items.begin(), items.end()), items.end());
+
+    // The siphash key is the first half of the block hash.
+    const auto block_hash = block.header().hash();
+    const auto k0 = read_word(&block_hash[0], 8);
+    const auto k1 = read_word(&block_hash[8], 8);
+    const auto range = items.size() * rice_modulus;
+
+    std::vector<uint64_t> values;
+    values.reserve(items.size());
+
+    for (const auto& item: items)
+        values.push_back(map_to_range(siphash(k0, k1, item), range));
+
+    std::sort(values.begin(), values.end());
+
+    // [ count:varint ][ golomb-rice coded deltas ]
+    data_chunk filter(variable_uint_size(values.size()));
+    auto serial = make_unsafe_serializer(filter.begin());
+    serial.write_variable_little_endian(values.size());
+
+    bit_writer writer(filter);
+    uint64_t previous = 0;
+
+    for (const auto value: values)
+    {
+        encode(writer, value - previous);
+        previous = value;
+    }
+
+    writer.flush();
+    return filter;
+}
+
+hash_digest block_filter::header(const data_chunk& filter,
+    const hash_digest& previous_header)
+{
+    return bitcoin_hash(build_chunk({ bitcoin_hash(filter), previous_header }));
+}
+
+} // namespace server
+} // namespace libbitcoin
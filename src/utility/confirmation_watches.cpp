@@ -0,0 +1,237 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/confirmation_watches.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/route.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+confirmation_watches::confirmation_watches()
+{
+}
+
+// Properties.
+// ----------------------------------------------------------------------------
+
+size_t confirmation_watches::size() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return unconfirmed_.size() + confirmed_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Subscription.
+// ----------------------------------------------------------------------------
+
+// Watches begin unconfirmed, so a confirming block is not missed.
+bool confirmation_watches::subscribe(watch_ptr watch, size_t limit)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    remove(watch->reply_to, watch->tx_hash);
+
+    if (unconfirmed_.size() + confirmed_.size() >= limit)
+        return false;
+
+    unconfirmed_.emplace(watch->tx_hash, watch);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void confirmation_watches::unsubscribe(const route& reply_to,
+    const hash_digest& tx_hash)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    remove(reply_to, tx_hash);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Confirmation.
+// ----------------------------------------------------------------------------
+
+void confirmation_watches::locate(watch_ptr watch, size_t height,
+    size_t top_height, update_list& out)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    auto range = unconfirmed_.equal_range(watch->tx_hash);
+    auto it = std::find_if(range.first, range.second,
+        [&](const unconfirmed_map::value_type& row)
+        {
+            return row.second == watch;
+        });
+
+    // The watch may have been confirmed by notification or removed.
+    if (it == range.second)
+        return;
+
+    unconfirmed_.erase(it);
+    confirm(watch, height);
+    reached(top_height, out);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void confirmation_watches::reorganize(size_t fork_height,
+    const block_const_ptr_list& new_blocks, update_list& out)
+{
+    const auto top_height = fork_height + new_blocks.size();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    // Confirmations above the fork point are reorganized out. Each watch is
+    // ordered at or above its confirmation height, so lower ones are skipped.
+    for (auto it = confirmed_.upper_bound(fork_height);
+        it != confirmed_.end();)
+    {
+        const auto watch = it->second;
+
+        if (watch->height <= fork_height)
+        {
+            ++it;
+            continue;
+        }
+
+        out.push_back({ watch->reply_to, watch->id, error::success,
+            watch->tx_hash, 0, 0 });
+
+        // All depths are notified again upon reconfirmation.
+        watch->next = 0;
+        watch->height = 0;
+        unconfirmed_.emplace(watch->tx_hash, watch);
+        it = confirmed_.erase(it);
+    }
+
+    auto height = fork_height;
+
+    for (const auto block: new_blocks)
+    {
+        ++height;
+
+        for (const auto& tx: block->transactions())
+        {
+            const auto range = unconfirmed_.equal_range(tx.hash());
+
+            for (auto it = range.first; it != range.second; ++it)
+                confirm(it->second, height);
+
+            unconfirmed_.erase(range.first, range.second);
+        }
+    }
+
+    reached(top_height, out);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void confirmation_watches::purge(const asio::time_point& now,
+    update_list& out)
+{
+    static const auto code = error::channel_timeout;
+
+    const auto expired = [&](const watch_ptr& watch)
+    {
+        if (watch->expires > now)
+            return false;
+
+        out.push_back({ watch->reply_to, watch->id, code, watch->tx_hash,
+            0, 0 });
+        return true;
+    };
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    for (auto it = unconfirmed_.begin(); it != unconfirmed_.end();)
+        it = expired(it->second) ? unconfirmed_.erase(it) : std::next(it);
+
+    for (auto it = confirmed_.begin(); it != confirmed_.end();)
+        it = expired(it->second) ? confirmed_.erase(it) : std::next(it);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Utilities.
+// ----------------------------------------------------------------------------
+
+// Order the watch by the height at which its next depth is reached.
+void confirmation_watches::confirm(watch_ptr watch, size_t height)
+{
+    BITCOIN_ASSERT(watch->next < watch->depths.size());
+    watch->height = height;
+    const auto depth = watch->depths[watch->next];
+    confirmed_.emplace(height + depth - 1, watch);
+}
+
+// Pop the watches whose next depth is reached, completed watches are dropped.
+void confirmation_watches::reached(size_t top_height, update_list& out)
+{
+    while (!confirmed_.empty() && confirmed_.begin()->first <= top_height)
+    {
+        const auto watch = confirmed_.begin()->second;
+        confirmed_.erase(confirmed_.begin());
+
+        // Depths reached together are notified together.
+        const auto depth = top_height - watch->height + 1;
+
+        while (watch->next < watch->depths.size() &&
+            watch->depths[watch->next] <= depth)
+        {
+            out.push_back({ watch->reply_to, watch->id, error::success,
+                watch->tx_hash, watch->depths[watch->next],
+                safe_unsigned<uint32_t>(watch->height) });
+            ++watch->next;
+        }
+
+        if (watch->next < watch->depths.size())
+            confirm(watch, watch->height);
+    }
+}
+
+void confirmation_watches::remove(const route& reply_to,
+    const hash_digest& tx_hash)
+{
+    const auto range = unconfirmed_.equal_range(tx_hash);
+
+    for (auto it = range.first; it != range.second;)
+        it = it->second->reply_to == reply_to ? unconfirmed_.erase(it) :
+            std::next(it);
+
+    for (auto it = confirmed_.begin(); it != confirmed_.end();)
+        it = it->second->reply_to == reply_to &&
+            it->second->tx_hash == tx_hash ? confirmed_.erase(it) :
+            std::next(it);
+}
+
+} // namespace server
+} // namespace libbitcoin
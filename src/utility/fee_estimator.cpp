@@ -0,0 +1,449 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/fee_estimator.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <boost/filesystem.hpp>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/configuration.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/server_node.hpp>
+#include <bitcoin/server/utility/fee_histogram.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+#define NAME "fee_estimator"
+
+using namespace std::placeholders;
+using namespace bc::chain;
+
+// The weight retained by prior statistics on each block (half-life ~350).
+static constexpr double decay = 0.998;
+
+// The fraction of a bucket that must confirm within the target.
+static constexpr double success_threshold = 0.85;
+
+// The decayed count below which a bucket is not considered.
+static constexpr double minimum_samples = 1.0;
+
+// [ buckets:1 ][ targets:1 ][[ total:8 ][[ confirmed:8 ]...]...]
+static constexpr size_t record_size = 2 * sizeof(uint8_t) +
+    fee_histogram::buckets * (fee_estimator::max_target + 1) *
+    sizeof(uint64_t);
+
+static uint64_t to_bits(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double from_bits(uint64_t bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+fee_estimator::fee_estimator(server_node& node,
+    const configuration& configuration)
+  : node_(node),
+    enabled_(configuration.server.fee_estimator_enabled),
+    save_interval_(configuration.server.fee_estimator_save_blocks),
+    path_(configuration.database.directory / NAME),
+    stats_{},
+    top_height_(0),
+    unsaved_(0),
+    started_(false)
+{
+}
+
+bool fee_estimator::enabled() const
+{
+    return enabled_;
+}
+
+// There is no unsubscribe so this class shouldn't be restarted.
+bool fee_estimator::start()
+{
+    if (save_interval_ > 0 && load())
+        LOG_INFO(LOG_SERVER)
+            << "The " NAME " statistics are restored.";
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+    started_ = true;
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Subscribe to blockchain reorganizations.
+    node_.subscribe_blockchain(
+        std::bind(&fee_estimator::handle_reorganization,
+            this, _1, _2, _3, _4));
+
+    // Subscribe to transaction pool acceptances.
+    node_.subscribe_transaction(
+        std::bind(&fee_estimator::handle_transaction,
+            this, _1, _2));
+
+    // Seed the top, a reorganization that precedes this takes precedence.
+    node_.chain().fetch_last_height(
+        std::bind(&fee_estimator::handle_last_height,
+            this, _1, _2));
+
+    return true;
+}
+
+// Statistics accumulated since the last save would otherwise be lost.
+bool fee_estimator::stop()
+{
+    if (save_interval_ == 0)
+        return true;
+
+    stats copy;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    if (!started_ || unsaved_ == 0)
+    {
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        return true;
+    }
+
+    unsaved_ = 0;
+    copy = stats_;
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    write(copy);
+    return true;
+}
+
+// Properties.
+// ----------------------------------------------------------------------------
+
+// Buckets are walked down from the highest rate until one fails the target.
+bool fee_estimator::estimate(size_t target, uint64_t& rate) const
+{
+    if (target == 0 || target > max_target)
+        return false;
+
+    auto found = false;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    for (auto index = fee_histogram::buckets; index > 0; --index)
+    {
+        const auto& bucket = stats_[index - 1];
+
+        if (bucket.total < minimum_samples)
+            continue;
+
+        if (bucket.confirmed[target - 1] / bucket.total < success_threshold)
+            break;
+
+        rate = fee_histogram::bounds[index - 1];
+        found = true;
+    }
+
+    return found;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Persistence.
+// ----------------------------------------------------------------------------
+
+bool fee_estimator::load()
+{
+    std::ifstream file(path_.string(), std::ios::binary);
+    data_chunk data(record_size);
+
+    if (!file.read(reinterpret_cast<char*>(data.data()), data.size()))
+        return false;
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+
+    // Statistics of other dimensions are discarded.
+    if (deserial.read_byte() != fee_histogram::buckets ||
+        deserial.read_byte() != max_target)
+        return false;
+
+    stats restored;
+
+    for (auto& bucket: restored)
+    {
+        bucket.total = from_bits(deserial.read_8_bytes_little_endian());
+
+        for (auto& confirmed: bucket.confirmed)
+            confirmed = from_bits(deserial.read_8_bytes_little_endian());
+    }
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    stats_ = restored;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool fee_estimator::save() const
+{
+    stats copy;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_shared();
+    copy = stats_;
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return write(copy);
+}
+
+// The file is written in full under a temporary name and then renamed over
+// the prior file, so a failure never leaves a partial file in its place.
+bool fee_estimator::write(const stats& copy) const
+{
+    data_chunk data(record_size);
+    auto serial = make_unsafe_serializer(data.begin());
+    serial.write_byte(static_cast<uint8_t>(fee_histogram::buckets));
+    serial.write_byte(static_cast<uint8_t>(max_target));
+
+    for (const auto& bucket: copy)
+    {
+        serial.write_8_bytes_little_endian(to_bits(bucket.total));
+
+        for (const auto confirmed: bucket.confirmed)
+            serial.write_8_bytes_little_endian(to_bits(confirmed));
+    }
+
+    auto temporary = path_;
+    temporary += ".tmp";
+
+    std::ofstream file(temporary.string(), std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    file.close();
+
+    if (!file)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure saving the " NAME " file " << temporary;
+        return false;
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::rename(temporary, path_, ec);
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure replacing the " NAME " file " << path_ << ": "
+            << ec.message();
+        return false;
+    }
+
+    return true;
+}
+
+// Statistics.
+// ----------------------------------------------------------------------------
+
+void fee_estimator::add(const hash_digest& tx_hash, uint64_t rate)
+{
+    const auto bucket = fee_histogram::bucket_index(rate);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    // Transactions accepted before the top is known are not tracked.
+    if (top_height_ == 0 ||
+        !entries_.emplace(tx_hash, entry{ bucket, top_height_ }).second)
+        return;
+
+    heights_[top_height_].push_back(tx_hash);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void fee_estimator::reorganize(size_t fork_height,
+    const block_const_ptr_list& blocks)
+{
+    stats copy;
+    auto save_now = false;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    auto height = fork_height;
+
+    for (const auto block: blocks)
+        connect(*block, ++height);
+
+    top_height_ = height;
+    unsaved_ += blocks.size();
+
+    // Saving at an interval bounds the writes on the notification thread.
+    if (save_interval_ > 0 && unsaved_ >= save_interval_)
+    {
+        unsaved_ = 0;
+        copy = stats_;
+        save_now = true;
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (save_now)
+        write(copy);
+}
+
+// Record the delays of the block, caller must hold the exclusive mutex.
+void fee_estimator::connect(const block& block, size_t height)
+{
+    for (auto& bucket: stats_)
+    {
+        bucket.total *= decay;
+
+        for (auto& confirmed: bucket.confirmed)
+            confirmed *= decay;
+    }
+
+    for (const auto& tx: block.transactions())
+    {
+        const auto it = entries_.find(tx.hash());
+
+        if (it == entries_.end())
+            continue;
+
+        // A transaction accepted at the top is at best confirmed in one.
+        const auto delay = height > it->second.height ?
+            height - it->second.height : 1;
+
+        auto& bucket = stats_[it->second.bucket];
+        bucket.total += 1.0;
+
+        for (auto target = delay; target <= max_target; ++target)
+            bucket.confirmed[target - 1] += 1.0;
+
+        entries_.erase(it);
+    }
+
+    expire(height);
+}
+
+// Count transactions pending beyond the maximum target, caller must hold
+// the exclusive mutex. Confirmed transactions have left the entries.
+void fee_estimator::expire(size_t height)
+{
+    while (!heights_.empty() && heights_.begin()->first + max_target < height)
+    {
+        const auto group = heights_.begin();
+
+        for (const auto& hash: group->second)
+        {
+            const auto it = entries_.find(hash);
+
+            if (it == entries_.end() || it->second.height != group->first)
+                continue;
+
+            stats_[it->second.bucket].total += 1.0;
+            entries_.erase(it);
+        }
+
+        heights_.erase(group);
+    }
+}
+
+// Notification.
+// ----------------------------------------------------------------------------
+
+void fee_estimator::handle_last_height(const code& ec, size_t height)
+{
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure seeding " NAME " height: " << ec.message();
+        return;
+    }
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (top_height_ == 0)
+        top_height_ = height;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool fee_estimator::handle_reorganization(const code& ec, size_t fork_height,
+    block_const_ptr_list_const_ptr new_blocks,
+    block_const_ptr_list_const_ptr)
+{
+    if (ec == error::service_stopped)
+        return false;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure handling new block: " << ec.message();
+
+        // Don't let a failure here prevent future notifications.
+        return true;
+    }
+
+    if (!new_blocks->empty())
+        reorganize(fork_height, *new_blocks);
+
+    return true;
+}
+
+bool fee_estimator::handle_transaction(const code& ec,
+    transaction_const_ptr tx)
+{
+    if (ec == error::service_stopped)
+        return false;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure handling new transaction: " << ec.message();
+
+        // Don't let a failure here prevent future notifications.
+        return true;
+    }
+
+    add(tx->hash(), fee_histogram::fee_rate(*tx));
+    return true;
+}
+
+} // namespace server
+} // namespace libbitcoin
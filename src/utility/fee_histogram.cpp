@@ -0,0 +1,221 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/fee_histogram.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/server_node.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace std::placeholders;
+
+const std::array<uint32_t, fee_histogram::buckets> fee_histogram::bounds
+{
+    {
+        0, 1, 2, 3, 4, 5, 6, 8, 10, 12, 15, 20, 25, 30, 40, 50, 60, 70, 80,
+        100, 120, 150, 200, 250, 300, 400, 500, 700, 1000, 1500, 2000, 5000
+    }
+};
+
+// The fee is valid as the previous outputs are populated by validation.
+uint64_t fee_histogram::fee_rate(const chain::transaction& tx)
+{
+    const uint64_t bytes = tx.serialized_size();
+    return tx.fees() / std::max(bytes, uint64_t(1));
+}
+
+size_t fee_histogram::bucket_index(uint64_t rate)
+{
+    const auto bound = std::upper_bound(bounds.begin(), bounds.end(), rate);
+    return std::distance(bounds.begin(), bound) - 1;
+}
+
+fee_histogram::fee_histogram(server_node& node,
+    const asio::duration& lifetime)
+  : node_(node),
+    lifetime_(lifetime),
+    buckets_{}
+{
+}
+
+// There is no unsubscribe so this class shouldn't be restarted.
+bool fee_histogram::start()
+{
+    // Subscribe to blockchain reorganizations.
+    node_.subscribe_blockchain(
+        std::bind(&fee_histogram::handle_reorganization,
+            this, _1, _2, _3, _4));
+
+    // Subscribe to transaction pool acceptances.
+    node_.subscribe_transaction(
+        std::bind(&fee_histogram::handle_transaction,
+            this, _1, _2));
+
+    return true;
+}
+
+// Properties.
+// ----------------------------------------------------------------------------
+
+data_chunk fee_histogram::to_data() const
+{
+    static constexpr size_t row_size = sizeof(uint32_t) + sizeof(uint32_t) +
+        sizeof(uint64_t);
+
+    data_chunk data(sizeof(uint8_t) + buckets * row_size);
+    auto serial = make_unsafe_serializer(data.begin());
+    serial.write_byte(static_cast<uint8_t>(buckets));
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    for (size_t index = 0; index < buckets; ++index)
+    {
+        serial.write_4_bytes_little_endian(bounds[index]);
+        serial.write_4_bytes_little_endian(buckets_[index].transactions);
+        serial.write_8_bytes_little_endian(buckets_[index].bytes);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    return data;
+}
+
+// Entries.
+// ----------------------------------------------------------------------------
+
+void fee_histogram::add(const hash_digest& tx_hash, uint64_t rate,
+    uint64_t bytes, const asio::time_point& expiry)
+{
+    const auto index = bucket_index(rate);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (!entries_.emplace(tx_hash, entry{ index, bytes, expiry }).second)
+        return;
+
+    auto& bucket = buckets_[index];
+    ++bucket.transactions;
+    bucket.bytes += bytes;
+    queue_.emplace_back(tx_hash, expiry);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void fee_histogram::remove(const hash_digest& tx_hash)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    const auto it = entries_.find(tx_hash);
+
+    if (it != entries_.end())
+        erase(it);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void fee_histogram::purge(const asio::time_point& now)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    // Skip those removed or since restored, as their expiry differs.
+    while (!queue_.empty() && queue_.front().second <= now)
+    {
+        const auto it = entries_.find(queue_.front().first);
+
+        if (it != entries_.end() && it->second.expiry == queue_.front().second)
+            erase(it);
+
+        queue_.pop_front();
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Caller must hold the exclusive mutex.
+void fee_histogram::erase(entry_map::iterator it)
+{
+    auto& bucket = buckets_[it->second.bucket];
+    --bucket.transactions;
+    bucket.bytes -= it->second.bytes;
+    entries_.erase(it);
+}
+
+// Notification.
+// ----------------------------------------------------------------------------
+
+bool fee_histogram::handle_reorganization(const code& ec, size_t,
+    block_const_ptr_list_const_ptr new_blocks,
+    block_const_ptr_list_const_ptr)
+{
+    if (ec == error::service_stopped)
+        return false;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure handling new block: " << ec.message();
+
+        // Don't let a failure here prevent future notifications.
+        return true;
+    }
+
+    purge(asio::steady_clock::now());
+
+    // Confirmed transactions are no longer counted as pooled.
+    for (const auto block: *new_blocks)
+        for (const auto& tx: block->transactions())
+            remove(tx.hash());
+
+    return true;
+}
+
+bool fee_histogram::handle_transaction(const code& ec,
+    transaction_const_ptr tx)
+{
+    if (ec == error::service_stopped)
+        return false;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure handling new transaction: " << ec.message();
+
+        // Don't let a failure here prevent future notifications.
+        return true;
+    }
+
+    const auto expiry = asio::steady_clock::now() + lifetime_;
+    add(tx->hash(), fee_rate(*tx), tx->serialized_size(), expiry);
+    return true;
+}
+
+} // namespace server
+} // namespace libbitcoin
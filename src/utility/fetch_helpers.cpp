@@ -20,13 +20,18 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
 #include <bitcoin/blockchain.hpp>
 #include <bitcoin/server/configuration.hpp>
 #include <bitcoin/server/messages/message.hpp>
+#include <bitcoin/server/server_node.hpp>
 
 namespace libbitcoin {
 namespace server {
 
+using namespace std::placeholders;
 using namespace bc::blockchain;
 using namespace bc::message;
 using namespace bc::wallet;
@@ -118,5 +123,111 @@ void transaction_fetched(const code& ec, transaction_ptr tx, size_t, size_t,
     handler(message(request, result));
 }
 
+// fetch_transactions stuff
+// ----------------------------------------------------------------------------
+
+typedef std::shared_ptr<std::vector<data_chunk>> chunks_ptr;
+
+bool unwrap_fetch_transactions_args(hash_list& hashes, const message& request)
+{
+    const auto& data = request.data();
+    const auto count = data.size() / hash_size;
+
+    if (data.empty() || data.size() % hash_size != 0 ||
+        count > query_batch_limit)
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "Invalid hash list length in fetch_transactions request.";
+        return false;
+    }
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    hashes.reserve(count);
+
+    for (size_t index = 0; index < count; ++index)
+        hashes.push_back(deserial.read_hash());
+
+    return true;
+}
+
+static void transactions_fetched(const code& ec, chunks_ptr items,
+    const message& request, send_handler handler)
+{
+    auto size = code_size + sizeof(uint32_t);
+
+    for (const auto& item: *items)
+        size += item.size();
+
+    // [ code:4 ]
+    // [ count:4 ]
+    // [[ code:4 ][ size:4 ][ tx... ]...]
+    data_chunk result;
+    result.reserve(size);
+    extend_data(result, message::to_bytes(ec));
+    extend_data(result, to_little_endian(
+        static_cast<uint32_t>(items->size())));
+
+    for (const auto& item: *items)
+        extend_data(result, item);
+
+    handler(message(request, result));
+}
+
+static void transaction_item_fetched(const code& ec, transaction_const_ptr tx,
+    size_t slot, chunks_ptr items, result_handler complete)
+{
+    // A failed lookup is reported in its item, not for the batch.
+    if (ec)
+    {
+        (*items)[slot] = build_chunk(
+        {
+            message::to_bytes(ec),
+            to_little_endian(uint32_t(0))
+        });
+    }
+    else
+    {
+        const auto data = tx->to_data(version::level::canonical);
+        (*items)[slot] = build_chunk(
+        {
+            message::to_bytes(error::success),
+            to_little_endian(static_cast<uint32_t>(data.size())),
+            data
+        });
+    }
+
+    complete(error::success);
+}
+
+static void fetch_transaction_item(server_node& node, const hash_digest& hash,
+    bool require_confirmed, size_t slot, chunks_ptr items,
+    result_handler complete)
+{
+    node.chain().fetch_transaction(hash, require_confirmed,
+        std::bind(transaction_item_fetched,
+            _1, _2, slot, items, complete));
+}
+
+// Each lookup is dispatched concurrently so that reads proceed in parallel.
+// Results are returned in request order regardless of completion order.
+// The response is sent from a dispatch thread, which the query worker routes
+// through its notify endpoint as its router socket is not thread safe.
+void fetch_transaction_list(server_node& node, const hash_list& hashes,
+    bool require_confirmed, const message& request, send_handler handler)
+{
+    const auto items = std::make_shared<std::vector<data_chunk>>(
+        hashes.size());
+
+    const auto complete = synchronize(
+        std::bind(transactions_fetched,
+            _1, items, request, handler),
+        hashes.size(), "fetch_transactions");
+
+    for (size_t slot = 0; slot < hashes.size(); ++slot)
+        node.query_dispatch().concurrent(fetch_transaction_item,
+            std::ref(node), hashes[slot], require_confirmed, slot, items,
+                complete);
+}
+
 } // namespace server
 } // namespace libbitcoin
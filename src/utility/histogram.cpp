@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/histogram.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+histogram::histogram()
+  : count_(0), total_(0)
+{
+    for (auto& bucket: buckets_)
+        bucket.store(0);
+}
+
+void histogram::record(const asio::duration& elapsed)
+{
+    const auto span = std::chrono::duration_cast<asio::microseconds>(elapsed);
+    const auto micro = span.count() < 0 ? 0 :
+        static_cast<uint64_t>(span.count());
+
+    size_t index = 0;
+    for (auto value = micro; value > 0 && index < buckets - 1; value >>= 1)
+        ++index;
+
+    ++buckets_[index];
+    total_ += micro;
+    ++count_;
+}
+
+uint64_t histogram::count() const
+{
+    return count_.load();
+}
+
+uint64_t histogram::total() const
+{
+    return total_.load();
+}
+
+uint64_t histogram::bucket(size_t index) const
+{
+    BITCOIN_ASSERT(index < buckets);
+    return buckets_[index].load();
+}
+
+data_chunk histogram::to_data() const
+{
+    static const auto size = sizeof(uint8_t) + 2 * sizeof(uint64_t) +
+        buckets * sizeof(uint64_t);
+
+    data_chunk data(size);
+    auto serial = make_unsafe_serializer(data.begin());
+    serial.write_byte(static_cast<uint8_t>(buckets));
+    serial.write_8_bytes_little_endian(count());
+    serial.write_8_bytes_little_endian(total());
+
+    for (const auto& bucket: buckets_)
+        serial.write_8_bytes_little_endian(bucket.load());
+
+    return data;
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,197 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/merkle_cache.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/server_node.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace std::placeholders;
+
+// Static.
+// ----------------------------------------------------------------------------
+
+// An odd hash at any level is paired with itself, as in the block header.
+merkle_cache::tree_ptr merkle_cache::build(const hash_list& hashes)
+{
+    const auto levels = std::make_shared<tree>();
+
+    if (hashes.empty())
+        return levels;
+
+    levels->push_back(hashes);
+
+    while (levels->back().size() > 1)
+    {
+        const auto& below = levels->back();
+        hash_list above;
+        above.reserve((below.size() + 1) / 2);
+
+        for (size_t index = 0; index < below.size(); index += 2)
+        {
+            const auto& left = below[index];
+            const auto& right = index + 1 < below.size() ? below[index + 1] :
+                left;
+
+            above.push_back(bitcoin_hash(build_chunk({ left, right })));
+        }
+
+        levels->push_back(std::move(above));
+    }
+
+    return levels;
+}
+
+hash_list merkle_cache::branch(const tree& tree, size_t position)
+{
+    hash_list hashes;
+
+    if (tree.empty())
+        return hashes;
+
+    hashes.reserve(tree.size() - 1);
+
+    // The root level contributes no sibling.
+    for (size_t level = 0; level + 1 < tree.size(); ++level)
+    {
+        const auto& row = tree[level];
+        const auto sibling = position ^ 1;
+        hashes.push_back(sibling < row.size() ? row[sibling] : row[position]);
+        position >>= 1;
+    }
+
+    return hashes;
+}
+
+// Construct.
+// ----------------------------------------------------------------------------
+
+merkle_cache::merkle_cache(server_node& node, size_t capacity)
+  : node_(node),
+    capacity_(capacity)
+{
+}
+
+// There is no unsubscribe so this class shouldn't be restarted.
+bool merkle_cache::start()
+{
+    // Subscribe to blockchain reorganizations.
+    node_.subscribe_blockchain(
+        std::bind(&merkle_cache::handle_reorganization,
+            this, _1, _2, _3, _4));
+
+    return true;
+}
+
+// Cache.
+// ----------------------------------------------------------------------------
+
+merkle_cache::tree_ptr merkle_cache::find(const hash_digest& block_hash)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    const auto it = index_.find(block_hash);
+
+    if (it == index_.end())
+        return nullptr;
+
+    // Promote the entry to most recently used.
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->second;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void merkle_cache::store(const hash_digest& block_hash, tree_ptr tree)
+{
+    if (capacity_ == 0)
+        return;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    const auto it = index_.find(block_hash);
+
+    if (it != index_.end())
+    {
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+
+    entries_.emplace_front(block_hash, tree);
+    index_[block_hash] = entries_.begin();
+
+    // Evict the least recently used entry.
+    if (entries_.size() > capacity_)
+    {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Notification.
+// ----------------------------------------------------------------------------
+
+bool merkle_cache::handle_reorganization(const code& ec, size_t,
+    block_const_ptr_list_const_ptr, block_const_ptr_list_const_ptr old_blocks)
+{
+    if (ec == error::service_stopped)
+        return false;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure handling new block: " << ec.message();
+
+        // Don't let a failure here prevent future notifications.
+        return true;
+    }
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    // Trees of blocks reorganized out can no longer be matched.
+    for (const auto block: *old_blocks)
+    {
+        const auto it = index_.find(block->hash());
+
+        if (it == index_.end())
+            continue;
+
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    return true;
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,223 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/relay_monitor.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/protocol.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/utility/histogram.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::protocol;
+
+// The leading byte of an xpub subscription frame.
+static constexpr uint8_t unsubscribe_frame = 0x00;
+static constexpr uint8_t subscribe_frame = 0x01;
+
+// The trailing frame of a worker message is [ entry:8 ][ serialized:8 ].
+static constexpr size_t timing_size = 2 * sizeof(uint64_t);
+
+static uint64_t to_microseconds(const asio::time_point& time)
+{
+    const auto since = time.time_since_epoch();
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<asio::microseconds>(since).count());
+}
+
+static asio::time_point from_microseconds(uint64_t micro)
+{
+    return asio::time_point(std::chrono::duration_cast<asio::duration>(
+        asio::microseconds(micro)));
+}
+
+relay_monitor::relay_monitor()
+  : forwarded_messages_(0),
+    forwarded_bytes_(0),
+    subscriptions_(0),
+    worker_backlog_(0),
+    peak_worker_backlog_(0)
+{
+}
+
+// Relay.
+// ----------------------------------------------------------------------------
+
+void relay_monitor::stamp(zmq::message& message,
+    const asio::time_point& entry)
+{
+    stamp(message, entry, entry);
+}
+
+// The latency of the message remains measured from entry.
+void relay_monitor::stamp(zmq::message& message,
+    const asio::time_point& entry, const asio::time_point& serializing)
+{
+    const auto serialized = asio::steady_clock::now();
+    serialization_.record(serialized - serializing);
+
+    message.enqueue(build_chunk(
+    {
+        to_little_endian(to_microseconds(entry)),
+        to_little_endian(to_microseconds(serialized))
+    }));
+}
+
+// The message is unpacked for measurement and repacked for relay. This costs
+// a copy per frame that the opaque proxy avoided, which is small relative to
+// serialization of the published block or transaction.
+code relay_monitor::forward(zmq::socket& xsub, zmq::socket& xpub)
+{
+    zmq::message message;
+    auto ec = xsub.receive(message);
+
+    if (ec)
+        return ec;
+
+    const auto received = asio::steady_clock::now();
+    std::vector<data_chunk> frames;
+
+    while (!message.empty())
+        frames.push_back(message.dequeue_data());
+
+    // All worker messages are stamped, so this is not expected to fail.
+    if (frames.size() < 2 || frames.back().size() != timing_size)
+        return error::bad_stream;
+
+    auto deserial = make_safe_deserializer(frames.back().begin(),
+        frames.back().end());
+    const auto entry = from_microseconds(
+        deserial.read_8_bytes_little_endian());
+    const auto serialized = from_microseconds(
+        deserial.read_8_bytes_little_endian());
+    frames.pop_back();
+
+    size_t bytes = 0;
+    zmq::message relay;
+
+    for (const auto& frame: frames)
+    {
+        bytes += frame.size();
+        relay.enqueue(frame);
+    }
+
+    ec = xpub.send(relay);
+
+    if (ec)
+        return ec;
+
+    const auto sent = asio::steady_clock::now();
+    handoff_.record(received - serialized);
+    send_.record(sent - received);
+    latency_.record(sent - entry);
+
+    ++forwarded_messages_;
+    forwarded_bytes_ += bytes;
+    return error::success;
+}
+
+code relay_monitor::subscribe(zmq::socket& xpub, zmq::socket& xsub)
+{
+    zmq::message message;
+    auto ec = xpub.receive(message);
+
+    if (ec)
+        return ec;
+
+    const auto frame = message.dequeue_data();
+
+    if (!frame.empty() && frame.front() == subscribe_frame)
+        ++subscriptions_;
+    else if (!frame.empty() && frame.front() == unsubscribe_frame &&
+        subscriptions_ > 0)
+        --subscriptions_;
+
+    zmq::message relay;
+    relay.enqueue(frame);
+    return xsub.send(relay);
+}
+
+void relay_monitor::backlog(bool pending)
+{
+    if (!pending)
+    {
+        worker_backlog_ = 0;
+        return;
+    }
+
+    const auto backlog = ++worker_backlog_;
+
+    if (backlog > peak_worker_backlog_)
+        peak_worker_backlog_ = backlog;
+}
+
+// Properties.
+// ----------------------------------------------------------------------------
+
+uint64_t relay_monitor::forwarded_messages() const
+{
+    return forwarded_messages_.load();
+}
+
+uint64_t relay_monitor::forwarded_bytes() const
+{
+    return forwarded_bytes_.load();
+}
+
+uint32_t relay_monitor::subscriptions() const
+{
+    return subscriptions_.load();
+}
+
+uint32_t relay_monitor::worker_backlog() const
+{
+    return worker_backlog_.load();
+}
+
+uint32_t relay_monitor::peak_worker_backlog() const
+{
+    return peak_worker_backlog_.load();
+}
+
+const histogram& relay_monitor::serialization() const
+{
+    return serialization_;
+}
+
+const histogram& relay_monitor::handoff() const
+{
+    return handoff_;
+}
+
+const histogram& relay_monitor::send() const
+{
+    return send_;
+}
+
+const histogram& relay_monitor::latency() const
+{
+    return latency_;
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,263 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/status_monitor.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/server_node.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace std::placeholders;
+
+status_monitor::status_monitor(server_node& node,
+    const asio::duration& lifetime)
+  : node_(node),
+    lifetime_(lifetime),
+    queries_(0),
+    query_microseconds_(0),
+    seeded_(false),
+    top_height_(0),
+    top_hash_(null_hash),
+    pool_sequence_(0)
+{
+}
+
+// There is no unsubscribe so this class shouldn't be restarted.
+bool status_monitor::start()
+{
+    // Subscribe to blockchain reorganizations.
+    node_.subscribe_blockchain(
+        std::bind(&status_monitor::handle_reorganization,
+            this, _1, _2, _3, _4));
+
+    // Subscribe to transaction pool acceptances.
+    node_.subscribe_transaction(
+        std::bind(&status_monitor::handle_transaction,
+            this, _1, _2));
+
+    // Seed the tip, a reorganization that precedes this takes precedence.
+    node_.chain().fetch_last_height(
+        std::bind(&status_monitor::handle_last_height,
+            this, _1, _2));
+
+    return true;
+}
+
+// Properties.
+// ----------------------------------------------------------------------------
+
+void status_monitor::top(size_t& height, hash_digest& hash) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    height = top_height_;
+    hash = top_hash_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t status_monitor::pool_size() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return pool_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+uint64_t status_monitor::pool(uint64_t from_sequence, pool_list& out) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_shared();
+
+    for (const auto& row: pool_)
+        if (row.second.sequence > from_sequence)
+            out.push_back({ row.first, row.second.size, row.second.sequence });
+
+    const auto sequence = pool_sequence_;
+
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Acceptance order places each parent before its pooled children.
+    std::sort(out.begin(), out.end(),
+        [](const pool_entry& left, const pool_entry& right)
+        {
+            return left.sequence < right.sequence;
+        });
+
+    return sequence;
+}
+
+size_t status_monitor::queries() const
+{
+    return queries_.load();
+}
+
+uint64_t status_monitor::query_microseconds() const
+{
+    return query_microseconds_.load();
+}
+
+// Query load.
+// ----------------------------------------------------------------------------
+
+void status_monitor::begin_query()
+{
+    ++queries_;
+}
+
+void status_monitor::end_query(const asio::time_point& started)
+{
+    const auto elapsed = asio::steady_clock::now() - started;
+    const auto span = std::chrono::duration_cast<asio::microseconds>(elapsed);
+    query_microseconds_ += static_cast<uint64_t>(span.count());
+    --queries_;
+}
+
+// Seeding.
+// ----------------------------------------------------------------------------
+
+void status_monitor::handle_last_height(const code& ec, size_t height)
+{
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure seeding status height: " << ec.message();
+        return;
+    }
+
+    node_.chain().fetch_block_header(height,
+        std::bind(&status_monitor::handle_header,
+            this, _1, _2, height));
+}
+
+void status_monitor::handle_header(const code& ec, header_const_ptr header,
+    size_t height)
+{
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure seeding status header: " << ec.message();
+        return;
+    }
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (seeded_)
+        return;
+
+    seeded_ = true;
+    top_height_ = height;
+    top_hash_ = header->hash();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Notification.
+// ----------------------------------------------------------------------------
+
+bool status_monitor::handle_reorganization(const code& ec,
+    size_t fork_height, block_const_ptr_list_const_ptr new_blocks,
+    block_const_ptr_list_const_ptr)
+{
+    if (ec == error::service_stopped)
+        return false;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure handling new block: " << ec.message();
+
+        // Don't let a failure here prevent future notifications.
+        return true;
+    }
+
+    if (new_blocks->empty())
+        return true;
+
+    const auto now = asio::steady_clock::now();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    seeded_ = true;
+    top_height_ = fork_height + new_blocks->size();
+    top_hash_ = new_blocks->back()->header().hash();
+
+    // Confirmed transactions are no longer counted as pooled.
+    for (const auto block: *new_blocks)
+        for (const auto& tx: block->transactions())
+            pool_.erase(tx.hash());
+
+    // The pool may have dropped a transaction without notice.
+    for (auto it = pool_.begin(); it != pool_.end();)
+        it = it->second.expires <= now ? pool_.erase(it) : std::next(it);
+    ///////////////////////////////////////////////////////////////////////////
+
+    return true;
+}
+
+bool status_monitor::handle_transaction(const code& ec,
+    transaction_const_ptr tx)
+{
+    if (ec == error::service_stopped)
+        return false;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure handling new transaction: " << ec.message();
+
+        // Don't let a failure here prevent future notifications.
+        return true;
+    }
+
+    const auto expires = asio::steady_clock::now() + lifetime_;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    // The sequence counts acceptances, so it is not reduced by confirmation.
+    pool_.emplace(tx->hash(), pool_row
+    {
+        static_cast<uint32_t>(tx->serialized_size(
+            bc::message::version::level::canonical)),
+        ++pool_sequence_,
+        expires
+    });
+    ///////////////////////////////////////////////////////////////////////////
+
+    return true;
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/verdict_cache.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <bitcoin/node.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/server_node.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace std::placeholders;
+
+verdict_cache::verdict_cache(server_node& node, size_t capacity,
+    const asio::duration& lifetime)
+  : node_(node),
+    capacity_(capacity),
+    lifetime_(lifetime)
+{
+}
+
+// There is no unsubscribe so this class shouldn't be restarted.
+bool verdict_cache::start()
+{
+    // Subscribe to blockchain reorganizations.
+    node_.subscribe_blockchain(
+        std::bind(&verdict_cache::handle_reorganization,
+            this, _1, _2, _3, _4));
+
+    return true;
+}
+
+// Cache.
+// ----------------------------------------------------------------------------
+
+bool verdict_cache::enabled() const
+{
+    return capacity_ > 0 && lifetime_ > asio::duration::zero();
+}
+
+bool verdict_cache::find(const hash_digest& key, code& verdict) const
+{
+    if (!enabled())
+        return false;
+
+    const auto now = asio::steady_clock::now();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    const auto it = entries_.find(key);
+
+    if (it == entries_.end() || it->second.second <= now)
+        return false;
+
+    verdict = it->second.first;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void verdict_cache::store(const hash_digest& key, const code& verdict)
+{
+    if (!enabled())
+        return;
+
+    const auto now = asio::steady_clock::now();
+    const auto expiry = now + lifetime_;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    entries_[key] = { verdict, expiry };
+    queue_.emplace_back(key, expiry);
+
+    // Drop expired and excess entries, skipping those since restored.
+    while (!queue_.empty() &&
+        (queue_.front().second <= now || entries_.size() > capacity_))
+    {
+        const auto it = entries_.find(queue_.front().first);
+
+        if (it != entries_.end() && it->second.second == queue_.front().second)
+            entries_.erase(it);
+
+        queue_.pop_front();
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Notification.
+// ----------------------------------------------------------------------------
+
+bool verdict_cache::handle_reorganization(const code& ec, size_t,
+    block_const_ptr_list_const_ptr, block_const_ptr_list_const_ptr)
+{
+    if (ec == error::service_stopped)
+        return false;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure handling new block: " << ec.message();
+
+        // Don't let a failure here prevent future notifications.
+        return true;
+    }
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    entries_.clear();
+    queue_.clear();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return true;
+}
+
+} // namespace server
+} // namespace libbitcoin
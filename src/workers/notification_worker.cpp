@@ -19,13 +19,17 @@
 #include <bitcoin/server/workers/notification_worker.hpp>
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
+#include <bitcoin/server/indexes/script_index.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/messages/route.hpp>
 #include <bitcoin/server/server_node.hpp>
@@ -48,6 +52,8 @@ using namespace bc::wallet;
 ////static const std::string address_stealth("address.stealth_update");
 ////static const std::string address_update("address.update");
 static const std::string address_update2("address.update2");
+static const std::string address_script_update("address.script_update");
+static const std::string transaction_update("transaction.update");
 
 notification_worker::notification_worker(zmq::authenticator& authenticator,
     server_node& node, bool secure)
@@ -57,7 +63,9 @@ notification_worker::notification_worker(zmq::authenticator& authenticator,
     node_(node),
     authenticator_(authenticator),
     address_subscriber_(std::make_shared<address_subscriber>(
-        node.thread_pool(), NAME "_address"))
+        node.thread_pool(), NAME "_address")),
+    script_subscriber_(std::make_shared<address_subscriber>(
+        node.thread_pool(), NAME "_script"))
     ////penetration_subscriber_(std::make_shared<penetration_subscriber>(
     ////    node.thread_pool(), NAME "_penetration"))
 {
@@ -67,6 +75,7 @@ notification_worker::notification_worker(zmq::authenticator& authenticator,
 bool notification_worker::start()
 {
     address_subscriber_->start();
+    script_subscriber_->start();
     ////penetration_subscriber_->start();
 
     // Subscribe to blockchain reorganizations.
@@ -96,6 +105,8 @@ bool notification_worker::stop()
 
     // Unlike purge, stop will not propagate, since the context is closed.
     address_subscriber_->invoke(error::service_stopped, {}, 0, {}, {});
+    script_subscriber_->stop();
+    script_subscriber_->invoke(error::service_stopped, {}, 0, {}, {});
 
     ////penetration_subscriber_->stop();
     ////penetration_subscriber_->invoke(error::service_stopped, 0, {}, {});
@@ -187,7 +198,24 @@ void notification_worker::purge()
     static const auto code = error::channel_timeout;
 
     address_subscriber_->purge(code, {}, 0, {}, {});
+    script_subscriber_->purge(code, {}, 0, {}, {});
     ////penetration_subscriber_->purge(code, 0, {}, {});
+
+    const auto now = asio::steady_clock::now();
+    update_list updates;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    script_mutex_.lock();
+
+    for (auto it = scripts_.begin(); it != scripts_.end();)
+        it = it->second <= now ? scripts_.erase(it) : std::next(it);
+
+    script_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    confirmations_.purge(now, updates);
+    send_confirmations(updates);
 }
 
 // Sending.
@@ -230,12 +258,13 @@ void notification_worker::send(const route& reply_to,
 bool notification_worker::handle_address(const code& ec,
     const binary& field, uint32_t height, const hash_digest& block_hash,
     transaction_const_ptr tx, const route& reply_to, uint32_t id,
-    const binary& prefix_filter, sequence_ptr sequence)
+    const binary& prefix_filter, const std::string& command,
+    sequence_ptr sequence)
 {
     if (ec)
     {
         // [ code:4 ]
-        send(reply_to, address_update2, id, message::to_bytes(ec));
+        send(reply_to, command, id, message::to_bytes(ec));
         return false;
     }
 
@@ -246,7 +275,7 @@ bool notification_worker::handle_address(const code& ec,
         // [ height:4 ]
         // [ block_hash:32 ]
         // [ tx:... ]
-        send(reply_to, address_update2, id, build_chunk(
+        send(reply_to, command, id, build_chunk(
         {
             message::to_bytes(error::success),
             to_little_endian(*sequence),
@@ -290,7 +319,7 @@ code notification_worker::subscribe_address(const route& reply_to, uint32_t id,
     auto handler =
         std::bind(&notification_worker::handle_address,
             this, _1, _2, _3, _4, _5, reply_to, id, prefix_filter,
-                sequence);
+                address_update2, sequence);
 
     // If the service is stopped a notification will result.
     address_subscriber_->subscribe(std::move(handler),
@@ -298,6 +327,109 @@ code notification_worker::subscribe_address(const route& reply_to, uint32_t id,
     return error::success;
 }
 
+// Subscribe to notifications of outputs to a script hash (sha256 of script).
+// The full hash is the filter, so only the one script is matched.
+code notification_worker::subscribe_script(const route& reply_to, uint32_t id,
+    const hash_digest& script_hash, bool unsubscribe)
+{
+    static constexpr size_t script_hash_bits = hash_size * byte_bits;
+    const binary filter(script_hash_bits, script_hash);
+    const address_key key(reply_to, filter);
+
+    if (unsubscribe)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        script_mutex_.lock();
+        scripts_.erase(key);
+        script_mutex_.unlock();
+        ///////////////////////////////////////////////////////////////////////
+
+        // Cause stored handler to be invoked but with specified error code.
+        script_subscriber_->unsubscribe(key, error::service_stopped, {}, 0,
+            {}, {});
+        return error::success;
+    }
+
+    // This allows resubscriptions at the service limit.
+    if (script_subscriber_->limited(key, settings_.subscription_limit))
+        return error::oversubscribed;
+
+    // The sequence enables the client to detect dropped messages.
+    const auto sequence = std::make_shared<uint16_t>(0);
+    const auto& duration = settings_.subscription_expiration();
+
+    auto handler =
+        std::bind(&notification_worker::handle_address,
+            this, _1, _2, _3, _4, _5, reply_to, id, filter,
+                address_script_update, sequence);
+
+    // If the service is stopped a notification will result.
+    script_subscriber_->subscribe(std::move(handler),
+        key, duration, error::service_stopped, {}, 0, {}, {});
+
+    // Expiry is set after the subscription's, so the map is a superset.
+    const auto expires = asio::steady_clock::now() + duration;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    script_mutex_.lock();
+    scripts_[key] = expires;
+    script_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return error::success;
+}
+
+// Subscribe to confirmation depth notifications of a transaction.
+// Resubscription replaces the depths and renews the expiration.
+code notification_worker::subscribe_confirmations(const route& reply_to,
+    uint32_t id, const hash_digest& tx_hash,
+    const std::vector<uint32_t>& depths, bool unsubscribe)
+{
+    if (stopped())
+        return error::service_stopped;
+
+    const auto expires = asio::steady_clock::now() +
+        settings_.subscription_expiration();
+
+    const auto watch = std::make_shared<confirmation_watches::watch>(
+        confirmation_watches::watch{ reply_to, id, tx_hash, depths, expires,
+            0, 0 });
+
+    if (unsubscribe)
+    {
+        confirmations_.unsubscribe(reply_to, tx_hash);
+        return error::success;
+    }
+
+    if (!confirmations_.subscribe(watch, settings_.subscription_limit))
+        return error::oversubscribed;
+
+    node_.chain().fetch_transaction_position(tx_hash, true,
+        std::bind(&notification_worker::handle_position,
+            this, _1, _3, watch));
+
+    return error::success;
+}
+
+// A transaction confirmed before subscription is located once.
+void notification_worker::handle_position(const code& ec, size_t height,
+    watch_ptr watch)
+{
+    // An unconfirmed transaction is located by block notification.
+    if (ec)
+        return;
+
+    size_t top_height;
+    hash_digest top_hash;
+    node_.status().top(top_height, top_hash);
+    update_list updates;
+
+    confirmations_.locate(watch, height, top_height, updates);
+    send_confirmations(updates);
+}
+
 ////// Subscribe to transaction penetration notifications.
 ////// Each delegate must connect to the appropriate query notification endpoint.
 ////void notification_worker::subscribe_penetration(const route& reply_to,
@@ -342,6 +474,7 @@ bool notification_worker::handle_reorganization(const code& ec,
     for (const auto block: *new_blocks)
         notify_block(safe_increment(fork_height32), block);
 
+    notify_confirmations(fork_height, new_blocks);
     return true;
 }
 
@@ -462,6 +595,18 @@ void notification_worker::notify_transaction(uint32_t height,
         }
     }
 
+    // Loop outputs and spends and extract script hashes, which include all
+    // scripts. Hashing is skipped when there is no script subscription.
+    if (scripted())
+    {
+        for (const auto& output: outputs)
+            notify_script(output.script(), height, block_hash, tx);
+
+        if (!tx->is_coinbase())
+            for (const auto& input: tx->inputs())
+                notify_spend(input.previous_output(), height, block_hash, tx);
+    }
+
     // see data_base::push_stealth
     // Loop output pairs and extract stealth payments.
     for (size_t index = 0; index < (outputs.size() - 1); ++index)
@@ -488,6 +633,91 @@ void notification_worker::notify_address(const binary& field, uint32_t height,
     address_subscriber_->relay(code, field, height, block_hash, tx);
 }
 
+void notification_worker::notify_script(const chain::script& script,
+    uint32_t height, const hash_digest& block_hash, transaction_const_ptr tx)
+{
+    static const auto code = error::success;
+    static constexpr size_t script_hash_bits = hash_size * byte_bits;
+    const auto script_hash = script_index::to_script_hash(script);
+    const binary field(script_hash_bits, script_hash);
+    script_subscriber_->relay(code, field, height, block_hash, tx);
+}
+
+// A spend is matched by the script of its previous output. This is populated
+// by validation, otherwise it is fetched from the chain or the pool.
+void notification_worker::notify_spend(const chain::output_point& prevout,
+    uint32_t height, const hash_digest& block_hash, transaction_const_ptr tx)
+{
+    const auto& cached = prevout.validation.cache;
+
+    if (cached.is_valid())
+    {
+        notify_script(cached.script(), height, block_hash, tx);
+        return;
+    }
+
+    node_.chain().fetch_transaction(prevout.hash(), false,
+        std::bind(&notification_worker::handle_spend,
+            this, _1, _2, prevout.index(), height, block_hash, tx));
+}
+
+void notification_worker::handle_spend(const code& ec,
+    transaction_const_ptr parent, uint32_t index, uint32_t height,
+    const hash_digest& block_hash, transaction_const_ptr tx)
+{
+    if (stopped() || ec || index >= parent->outputs().size())
+        return;
+
+    notify_script(parent->outputs()[index].script(), height, block_hash, tx);
+}
+
+bool notification_worker::scripted() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(script_mutex_);
+    return !scripts_.empty();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Notification (confirmations).
+// ----------------------------------------------------------------------------
+
+void notification_worker::notify_confirmations(size_t fork_height,
+    block_const_ptr_list_const_ptr new_blocks)
+{
+    update_list updates;
+    confirmations_.reorganize(fork_height, *new_blocks, updates);
+    send_confirmations(updates);
+}
+
+// A depth of zero signals that the confirmation was reorganized out.
+void notification_worker::send_confirmations(const update_list& updates)
+{
+    for (const auto& update: updates)
+    {
+        if (update.ec)
+        {
+            // [ code:4 ]
+            send(update.reply_to, transaction_update, update.id,
+                message::to_bytes(update.ec));
+            continue;
+        }
+
+        // [ code:4 ]
+        // [ tx_hash:32 ]
+        // [ depth:4 ]
+        // [ height:4 ]
+        send(update.reply_to, transaction_update, update.id, build_chunk(
+        {
+            message::to_bytes(error::success),
+            update.tx_hash,
+            to_little_endian(update.depth),
+            to_little_endian(update.height)
+        }));
+    }
+}
+
 ////// v3.x
 ////void notification_worker::notify_penetration(uint32_t height,
 ////    const hash_digest& block_hash, const hash_digest& tx_hash)
@@ -18,16 +18,23 @@
  */
 #include <bitcoin/server/workers/query_worker.hpp>
 
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <string>
+#include <thread>
+#include <utility>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/interface/address.hpp>
 #include <bitcoin/server/interface/blockchain.hpp>
 #include <bitcoin/server/interface/protocol.hpp>
+#include <bitcoin/server/interface/statistics.hpp>
+#include <bitcoin/server/interface/transaction.hpp>
 #include <bitcoin/server/interface/transaction_pool.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/server_node.hpp>
+#include <bitcoin/server/services/query_service.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -59,6 +66,9 @@ void query_worker::work()
     if (!started(connect(router)))
         return;
 
+    // Responses completed on other threads must not use the router.
+    thread_ = std::this_thread::get_id();
+
     zmq::poller poller;
     poller.add(router);
 
@@ -122,9 +132,12 @@ void query_worker::query(zmq::socket& router)
 
     // TODO: rewrite the serial blockchain interface to avoid callbacks.
     // We are using a closure vs. bind to take advantage of move arg syntax.
-    const auto sender = [&router](message&& response)
+    // A concurrent query completes on another thread, which cannot share the
+    // router, so its response is routed through the notify endpoint.
+    const auto sender = [this, &router](message&& response)
     {
-        const auto ec = response.send(router);
+        const auto ec = std::this_thread::get_id() == thread_ ?
+            response.send(router) : send(response);
 
         if (ec && ec != error::service_stopped)
             LOG_WARNING(LOG_SERVER)
@@ -169,10 +182,42 @@ void query_worker::query(zmq::socket& router)
     // The query executor is the delegate bound by the attach method.
     const auto& query_execute = handler->second;
 
+    // Account for the query until its response is sent (status reporting).
+    auto& status = node_.status();
+    const auto started = asio::steady_clock::now();
+    const auto answered = std::make_shared<std::atomic<bool>>(false);
+    status.begin_query();
+
+    // Streamed queries send several responses, the first answers the query.
+    const auto tracker = [sender, &status, started, answered](
+        message&& response)
+    {
+        sender(std::move(response));
+
+        if (!answered->exchange(true))
+            status.end_query(started);
+    };
+
     // Execute the request and forward result to queue.
-    // Example: address.renew(node_, request, sender);
-    // Example: blockchain.fetch_history2(node_, request, sender);
-    query_execute(request, sender);
+    // Example: address.renew(node_, request, tracker);
+    // Example: blockchain.fetch_history2(node_, request, tracker);
+    query_execute(request, tracker);
+}
+
+// Notifications are formatted as query responses, so share the endpoint.
+// This connects a socket for each response, as it is on the calling thread.
+code query_worker::send(message& response)
+{
+    const auto& endpoint = secure_ ? query_service::secure_notify :
+        query_service::public_notify;
+
+    zmq::socket notifier(authenticator_, zmq::socket::role::router);
+    const auto ec = notifier.connect(endpoint);
+
+    if (ec)
+        return ec;
+
+    return response.send(notifier);
 }
 
 // Query Interface.
@@ -204,6 +249,8 @@ void query_worker::attach(const std::string& command,
 // address.subscribe is obsoleted in v3.
 // address.subscribe2 is new in v3, also call for renew.
 // address.unsubscribe2 is new in v3 (there was never an address.unsubscribe).
+// address.subscribe_script is new in v3, also call for renew.
+// address.unsubscribe_script is new in v3.
 //-----------------------------------------------------------------------------
 // blockchain.validate is new in v3 (blocks).
 // blockchain.broadcast is new in v3 (blocks).
@@ -212,13 +259,40 @@ void query_worker::attach(const std::string& command,
 // blockchain.fetch_stealth is obsoleted in v3 (hash reversal).
 // blockchain.fetch_stealth2 is new in v3.
 // blockchain.fetch_stealth_transaction is new in v3 (safe version).
+// blockchain.fetch_balance is new in v3 (address index).
+// blockchain.fetch_unspent is new in v3 (address index).
+// blockchain.fetch_account_history is new in v3.
+// blockchain.fetch_transactions is new in v3 (batch).
+// blockchain.fetch_spends is new in v3 (batch).
+// blockchain.fetch_block is new in v3.
+// blockchain.fetch_merkle_proof is new in v3.
+// blockchain.fetch_filter is new in v3 (filter index).
+// blockchain.fetch_filter_headers is new in v3 (filter index).
+// blockchain.fetch_filters is new in v3 (filter index).
+// blockchain.fetch_block_headers is new in v3 (header index).
+// blockchain.fetch_height_by_time is new in v3 (header index).
+// blockchain.estimate_fee is new in v3.
+// blockchain.fetch_script_history is new in v3 (script index).
+// blockchain.fetch_script_balance is new in v3 (script index).
 //-----------------------------------------------------------------------------
 // transaction_pool.validate is obsoleted in v3 (reason?).
 // transaction_pool.validate2 is new in v3.
 // transaction_pool.broadcast is new in v3 (rename).
 // transaction_pool.fetch_transaction is enhanced in v3 (adds confirmed txs).
+// transaction_pool.fetch_transactions is new in v3 (batch).
+// transaction_pool.fetch_history is new in v3 (mempool index).
+// transaction_pool.fetch_prevouts is new in v3.
+// transaction_pool.fetch_fee_histogram is new in v3.
+// transaction_pool.broadcast_transactions is new in v3 (batch).
+// transaction_pool.fetch_snapshot is new in v3 (streamed).
+//-----------------------------------------------------------------------------
+// transaction.subscribe_confirmations is new in v3, also call for renew.
+// transaction.unsubscribe_confirmations is new in v3.
 //-----------------------------------------------------------------------------
 // protocol.broadcast_transaction is obsoleted in v3 (renamed).
+//-----------------------------------------------------------------------------
+// statistics.fetch_relays is new in v3.
+// statistics.fetch_latencies is new in v3.
 //=============================================================================
 // Interface class.method names must match protocol (do not change).
 void query_worker::attach_interface()
@@ -228,6 +302,8 @@ void query_worker::attach_interface()
     ////ATTACH(address, fetch_history, node_);                  // obsoleted
     ATTACH(address, subscribe2, node_);                         // new
     ATTACH(address, unsubscribe2, node_);                       // new
+    ATTACH(address, subscribe_script, node_);                   // new
+    ATTACH(address, unsubscribe_script, node_);                 // new
 
     ////ATTACH(blockchain, fetch_stealth, node_);               // obsoleted
     ////ATTACH(blockchain, fetch_history, node_);               // obsoleted
@@ -241,16 +317,43 @@ void query_worker::attach_interface()
     ATTACH(blockchain, fetch_history2, node_);                  // new
     ATTACH(blockchain, fetch_stealth2, node_);                  // new
     ATTACH(blockchain, fetch_stealth_transaction, node_);       // new
+    ATTACH(blockchain, fetch_balance, node_);                   // new
+    ATTACH(blockchain, fetch_unspent, node_);                   // new
+    ATTACH(blockchain, fetch_account_history, node_);           // new
+    ATTACH(blockchain, fetch_transactions, node_);              // new
+    ATTACH(blockchain, fetch_spends, node_);                    // new
+    ATTACH(blockchain, fetch_block, node_);                     // new
+    ATTACH(blockchain, fetch_merkle_proof, node_);              // new
+    ATTACH(blockchain, fetch_filter, node_);                    // new
+    ATTACH(blockchain, fetch_filter_headers, node_);            // new
+    ATTACH(blockchain, fetch_filters, node_);                   // new
+    ATTACH(blockchain, fetch_block_headers, node_);             // new
+    ATTACH(blockchain, fetch_height_by_time, node_);            // new
+    ATTACH(blockchain, estimate_fee, node_);                    // new
+    ATTACH(blockchain, fetch_script_history, node_);            // new
+    ATTACH(blockchain, fetch_script_balance, node_);            // new
     ATTACH(blockchain, broadcast, node_);                       // new
     ATTACH(blockchain, validate, node_);                        // new
 
     ////ATTACH(transaction_pool, validate, node_);              // obsoleted
     ATTACH(transaction_pool, fetch_transaction, node_);         // enhanced
+    ATTACH(transaction_pool, fetch_transactions, node_);        // new
+    ATTACH(transaction_pool, fetch_history, node_);             // new
+    ATTACH(transaction_pool, fetch_prevouts, node_);            // new
+    ATTACH(transaction_pool, fetch_fee_histogram, node_);       // new
+    ATTACH(transaction_pool, fetch_snapshot, node_);            // new
     ATTACH(transaction_pool, broadcast, node_);                 // new
+    ATTACH(transaction_pool, broadcast_transactions, node_);    // new
     ATTACH(transaction_pool, validate2, node_);                 // new
 
+    ATTACH(transaction, subscribe_confirmations, node_);        // new
+    ATTACH(transaction, unsubscribe_confirmations, node_);      // new
+
     ////ATTACH(protocol, broadcast_transaction, node_);         // obsoleted
     ATTACH(protocol, total_connections, node_);                 // original
+
+    ATTACH(statistics, fetch_relays, node_);                    // new
+    ATTACH(statistics, fetch_latencies, node_);                 // new
 }
 
 #undef ATTACH
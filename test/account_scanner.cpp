@@ -0,0 +1,178 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(account_scanner_tests)
+
+// The node is not started, its threads run the probes.
+static const configuration configured(config::settings::mainnet);
+
+static constexpr uint8_t version = 0x00;
+static constexpr uint32_t gap_limit = 3;
+
+typedef std::pair<uint32_t, uint32_t> position;
+typedef std::vector<position> position_list;
+
+static const wallet::hd_public account_key = wallet::hd_private(
+    data_chunk(16, 0x42)).to_public();
+
+static short_hash address_hash(const position& at)
+{
+    return bitcoin_short_hash(account_key.derive_public(at.first)
+        .derive_public(at.second).point());
+}
+
+// Each used address has one output in its history.
+class scanner
+  : public account_scanner
+{
+public:
+    scanner(server_node& node, const position_list& used)
+      : account_scanner(node, account_key, version, gap_limit, 0)
+    {
+        for (const auto& at: used)
+            used_.insert(address_hash(at));
+    }
+
+protected:
+    void fetch_history(const wallet::payment_address& address,
+        history_handler handler) override
+    {
+        chain::history_compact::list history;
+
+        if (used_.find(address.hash()) != used_.end())
+        {
+            chain::history_compact row;
+            row.kind = chain::point_kind::output;
+            row.point = chain::point(null_hash, 0);
+            row.height = 1;
+            row.value = 42;
+            history.push_back(row);
+        }
+
+        handler(error::success, history);
+    }
+
+private:
+    std::set<short_hash> used_;
+};
+
+// Scan the chains and wait for the result.
+static code scan(server_node& node, const position_list& used,
+    const std::vector<uint32_t>& chains, position_list& found)
+{
+    std::promise<code> promise;
+    auto hashed = true;
+    const auto instance = std::make_shared<scanner>(node, used);
+
+    // The handler may be invoked on a node thread.
+    instance->start(chains,
+        [&](const code& ec, const account_scanner::list& addresses)
+        {
+            for (const auto& address: addresses)
+            {
+                const position at{ address.chain, address.index };
+                hashed &= address.hash == address_hash(at);
+                found.push_back(at);
+            }
+
+            promise.set_value(ec);
+        });
+
+    const auto ec = promise.get_future().get();
+    BOOST_REQUIRE(hashed);
+    return ec;
+}
+
+struct thread_fixture
+{
+    thread_fixture()
+      : node(configured)
+    {
+        node.thread_pool().spawn(2);
+    }
+
+    ~thread_fixture()
+    {
+        node.thread_pool().shutdown();
+        node.thread_pool().join();
+    }
+
+    server_node node;
+};
+
+BOOST_FIXTURE_TEST_CASE(account_scanner__start__no_chains__empty,
+    thread_fixture)
+{
+    position_list found;
+    BOOST_REQUIRE_EQUAL(scan(node, {}, {}, found), error::success);
+    BOOST_REQUIRE(found.empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(account_scanner__start__hardened_chain__bad_stream,
+    thread_fixture)
+{
+    position_list found;
+    const std::vector<uint32_t> chains{ wallet::hd_first_hardened_key };
+    BOOST_REQUIRE_EQUAL(scan(node, {}, chains, found), error::bad_stream);
+}
+
+BOOST_FIXTURE_TEST_CASE(account_scanner__start__unused__empty,
+    thread_fixture)
+{
+    position_list found;
+    BOOST_REQUIRE_EQUAL(scan(node, {}, { 0, 1 }, found), error::success);
+    BOOST_REQUIRE(found.empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(account_scanner__start__within_gap__ordered,
+    thread_fixture)
+{
+    position_list found;
+    const position_list used{ { 1, 1 }, { 0, 4 }, { 0, 0 } };
+    BOOST_REQUIRE_EQUAL(scan(node, used, { 1, 0 }, found), error::success);
+    BOOST_REQUIRE(found == position_list({ { 0, 0 }, { 0, 4 }, { 1, 1 } }));
+}
+
+BOOST_FIXTURE_TEST_CASE(account_scanner__start__beyond_gap__not_found,
+    thread_fixture)
+{
+    position_list found;
+    const position_list used{ { 0, 0 }, { 0, 6 }, { 0, gap_limit } };
+    BOOST_REQUIRE_EQUAL(scan(node, { { 0, 0 }, { 0, 7 } }, { 0 }, found),
+        error::success);
+    BOOST_REQUIRE(found == position_list({ { 0, 0 } }));
+
+    found.clear();
+    BOOST_REQUIRE_EQUAL(scan(node, used, { 0 }, found), error::success);
+    BOOST_REQUIRE(found == position_list({ { 0, 0 }, { 0, 3 }, { 0, 6 } }));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,248 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(address_index_tests)
+
+// The node is not started, the index is prepared and linked directly.
+static const configuration configured(config::settings::mainnet);
+static const size_t start_height = configured.database.index_start_height;
+
+// Blocks spend only outputs of the same block, so prepare completes in place.
+class indexer
+  : public address_index
+{
+public:
+    indexer(server_node& node)
+      : address_index(node, configured)
+    {
+    }
+
+    size_t append(block_const_ptr block, size_t height)
+    {
+        auto prepared = false;
+        prepare(block, height, [&](const code& ec) { prepared = !ec; });
+        BOOST_REQUIRE(prepared);
+
+        unique_lock lock(mutex_);
+        return link({ block }, height);
+    }
+
+    bool rollback(size_t fork_height, block_const_ptr block)
+    {
+        unique_lock lock(mutex_);
+        return unlink(fork_height, { block });
+    }
+};
+
+static short_hash address(uint8_t key)
+{
+    short_hash hash{};
+    hash.front() = key;
+    return hash;
+}
+
+static chain::output pay(uint64_t value, uint8_t key)
+{
+    return chain::output(value,
+        chain::script(chain::script::to_pay_key_hash_pattern(address(key))));
+}
+
+// Coinbase transactions are distinguished by height.
+static chain::transaction coinbase(size_t height, uint64_t value, uint8_t key)
+{
+    const auto sequence = static_cast<uint32_t>(height);
+    const chain::input input(chain::output_point(null_hash,
+        chain::point::null_index), chain::script{}, sequence);
+    return chain::transaction(1, 0, { input }, { pay(value, key) });
+}
+
+static chain::transaction spend(const chain::transaction& parent,
+    chain::output::list&& outputs)
+{
+    const chain::input input(chain::output_point(parent.hash(), 0),
+        chain::script{}, max_input_sequence);
+    return chain::transaction(1, 0, { input }, std::move(outputs));
+}
+
+static block_const_ptr make_block(const hash_digest& previous,
+    chain::transaction::list&& transactions)
+{
+    return std::make_shared<const message::block>(
+        chain::header(1, previous, null_hash, 0, 0, 0),
+        std::move(transactions));
+}
+
+// Address 1 mines 50 and pays 30 of it to address 2, keeping 15 as change.
+static block_const_ptr first_block()
+{
+    const auto mined = coinbase(start_height, 50, 1);
+    const auto paid = spend(mined, { pay(30, 2), pay(15, 1) });
+    return make_block(null_hash, { mined, paid });
+}
+
+// Address 1 mines 10 and pays all of it to address 2.
+static block_const_ptr second_block(const hash_digest& previous)
+{
+    const auto mined = coinbase(start_height + 1, 10, 1);
+    const auto paid = spend(mined, { pay(10, 2) });
+    return make_block(previous, { mined, paid });
+}
+
+static void require_balance(const indexer& index, uint8_t key,
+    size_t expected_height, uint64_t expected_received,
+    uint64_t expected_spent)
+{
+    size_t height;
+    uint64_t received;
+    uint64_t spent;
+    BOOST_REQUIRE(index.balance(address(key), height, received, spent));
+    BOOST_REQUIRE_EQUAL(height, expected_height);
+    BOOST_REQUIRE_EQUAL(received, expected_received);
+    BOOST_REQUIRE_EQUAL(spent, expected_spent);
+}
+
+static address_index::unspent_list unspent(const indexer& index, uint8_t key)
+{
+    size_t height;
+    address_index::unspent_list outputs;
+    BOOST_REQUIRE(index.unspent(address(key), height, outputs));
+    return outputs;
+}
+
+BOOST_AUTO_TEST_CASE(address_index__balance__empty__false)
+{
+    server_node node(configured);
+    indexer index(node);
+    size_t height;
+    uint64_t received;
+    uint64_t spent;
+    BOOST_REQUIRE(!index.balance(address(1), height, received, spent));
+}
+
+BOOST_AUTO_TEST_CASE(address_index__balance__connected__received_and_spent)
+{
+    server_node node(configured);
+    indexer index(node);
+    BOOST_REQUIRE_EQUAL(index.append(first_block(), start_height), 1u);
+
+    require_balance(index, 1, start_height, 65, 50);
+    require_balance(index, 2, start_height, 30, 0);
+    require_balance(index, 3, start_height, 0, 0);
+}
+
+BOOST_AUTO_TEST_CASE(address_index__balance__second_block__accumulated)
+{
+    server_node node(configured);
+    indexer index(node);
+    const auto first = first_block();
+    const auto second = second_block(first->header().hash());
+    BOOST_REQUIRE_EQUAL(index.append(first, start_height), 1u);
+    BOOST_REQUIRE_EQUAL(index.append(second, start_height + 1), 1u);
+
+    require_balance(index, 1, start_height + 1, 75, 60);
+    require_balance(index, 2, start_height + 1, 40, 0);
+}
+
+BOOST_AUTO_TEST_CASE(address_index__balance__disconnected__restored)
+{
+    server_node node(configured);
+    indexer index(node);
+    const auto first = first_block();
+    const auto second = second_block(first->header().hash());
+    BOOST_REQUIRE_EQUAL(index.append(first, start_height), 1u);
+    BOOST_REQUIRE_EQUAL(index.append(second, start_height + 1), 1u);
+    BOOST_REQUIRE(index.rollback(start_height, second));
+
+    require_balance(index, 1, start_height, 65, 50);
+    require_balance(index, 2, start_height, 30, 0);
+}
+
+BOOST_AUTO_TEST_CASE(address_index__balance__reconnected__matches_connected)
+{
+    server_node node(configured);
+    indexer index(node);
+    const auto first = first_block();
+    const auto second = second_block(first->header().hash());
+    BOOST_REQUIRE_EQUAL(index.append(first, start_height), 1u);
+    BOOST_REQUIRE_EQUAL(index.append(second, start_height + 1), 1u);
+    BOOST_REQUIRE(index.rollback(start_height, second));
+    BOOST_REQUIRE_EQUAL(index.append(second, start_height + 1), 1u);
+
+    require_balance(index, 1, start_height + 1, 75, 60);
+    require_balance(index, 2, start_height + 1, 40, 0);
+}
+
+BOOST_AUTO_TEST_CASE(address_index__unspent__empty__false)
+{
+    server_node node(configured);
+    indexer index(node);
+    size_t height;
+    address_index::unspent_list outputs;
+    BOOST_REQUIRE(!index.unspent(address(1), height, outputs));
+}
+
+BOOST_AUTO_TEST_CASE(address_index__unspent__local_spend__excluded)
+{
+    server_node node(configured);
+    indexer index(node);
+    const auto first = first_block();
+    const auto& paid = first->transactions()[1];
+    BOOST_REQUIRE_EQUAL(index.append(first, start_height), 1u);
+
+    const auto change = unspent(index, 1);
+    BOOST_REQUIRE_EQUAL(change.size(), 1u);
+    BOOST_REQUIRE(change[0].point == chain::output_point(paid.hash(), 1));
+    BOOST_REQUIRE_EQUAL(change[0].value, 15u);
+    BOOST_REQUIRE_EQUAL(change[0].height, start_height);
+
+    const auto payment = unspent(index, 2);
+    BOOST_REQUIRE_EQUAL(payment.size(), 1u);
+    BOOST_REQUIRE(payment[0].point == chain::output_point(paid.hash(), 0));
+    BOOST_REQUIRE_EQUAL(payment[0].value, 30u);
+    BOOST_REQUIRE(unspent(index, 3).empty());
+}
+
+BOOST_AUTO_TEST_CASE(address_index__unspent__disconnected__restored)
+{
+    server_node node(configured);
+    indexer index(node);
+    const auto first = first_block();
+    const auto second = second_block(first->header().hash());
+    BOOST_REQUIRE_EQUAL(index.append(first, start_height), 1u);
+    BOOST_REQUIRE_EQUAL(index.append(second, start_height + 1), 1u);
+    BOOST_REQUIRE_EQUAL(unspent(index, 1).size(), 1u);
+    BOOST_REQUIRE_EQUAL(unspent(index, 2).size(), 2u);
+
+    BOOST_REQUIRE(index.rollback(start_height, second));
+    const auto payment = unspent(index, 2);
+    BOOST_REQUIRE_EQUAL(payment.size(), 1u);
+    BOOST_REQUIRE(payment[0].point ==
+        chain::output_point(first->transactions()[1].hash(), 0));
+    BOOST_REQUIRE_EQUAL(unspent(index, 1).size(), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
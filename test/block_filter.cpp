@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(block_filter_tests)
+
+// The testnet genesis block.
+static const auto genesis_block = "0100000000000000000000000000000000000000000000000000000000000000000000003ba3edfd7a7b12b27ac72c3e67768f617fc81bc3888a51323a9fb8aa4b1e5e4adae5494dffff001d1aa4ae180101000000010000000000000000000000000000000000000000000000000000000000000000ffffffff4d04ffff001d0104455468652054696d65732030332f4a616e2f32303039204368616e63656c6c6f72206f6e206272696e6b206f66207365636f6e64206261696c6f757420666f722062616e6b73ffffffff0100f2052a01000000434104678afdb0fe5548271967f1a67130b7105cd6a828e03909a67962e0ea1f61deb649f6bc3f4cef38c4f35504e51ec112de5c384df7ba0b8d578a4c702b6bf11d5fac00000000";
+
+// The testnet genesis block with null data and empty script outputs added.
+static const auto excluded_block = "0100000000000000000000000000000000000000000000000000000000000000000000003ba3edfd7a7b12b27ac72c3e67768f617fc81bc3888a51323a9fb8aa4b1e5e4adae5494dffff001d1aa4ae180101000000010000000000000000000000000000000000000000000000000000000000000000ffffffff4d04ffff001d0104455468652054696d65732030332f4a616e2f32303039204368616e63656c6c6f72206f6e206272696e6b206f66207365636f6e64206261696c6f757420666f722062616e6b73ffffffff0300f2052a01000000434104678afdb0fe5548271967f1a67130b7105cd6a828e03909a67962e0ea1f61deb649f6bc3f4cef38c4f35504e51ec112de5c384df7ba0b8d578a4c702b6bf11d5fac0000000000000000026a0000000000000000000000000000";
+
+// The genesis output script, duplicated as a spent script.
+static const auto duplicate_script = "4104678afdb0fe5548271967f1a67130b7105cd6a828e03909a67962e0ea1f61deb649f6bc3f4cef38c4f35504e51ec112de5c384df7ba0b8d578a4c702b6bf11d5fac";
+
+static const auto spent_script = "76a914111111111111111111111111111111111111111188ac";
+
+static data_chunk decode_chunk(const std::string& encoded)
+{
+    data_chunk data;
+    BOOST_REQUIRE(decode_base16(data, encoded));
+    return data;
+}
+
+static chain::block to_block(const std::string& encoded)
+{
+    chain::block block;
+    BOOST_REQUIRE(block.from_data(decode_chunk(encoded)));
+    return block;
+}
+
+BOOST_AUTO_TEST_CASE(block_filter__compute__genesis__expected)
+{
+    const auto block = to_block(genesis_block);
+    const auto filter = block_filter::compute(block, {});
+    BOOST_REQUIRE_EQUAL(encode_base16(filter), "019dfca8");
+}
+
+BOOST_AUTO_TEST_CASE(block_filter__compute__no_scripts__count_only)
+{
+    const chain::block block;
+    const auto filter = block_filter::compute(block, {});
+    BOOST_REQUIRE_EQUAL(encode_base16(filter), "00");
+}
+
+BOOST_AUTO_TEST_CASE(block_filter__compute__excluded_and_duplicate_scripts__expected)
+{
+    const auto block = to_block(excluded_block);
+    const data_stack prevouts
+    {
+        decode_chunk(duplicate_script), decode_chunk(spent_script), {}
+    };
+
+    const auto filter = block_filter::compute(block, prevouts);
+    BOOST_REQUIRE_EQUAL(encode_base16(filter), "0266de1c445280");
+}
+
+BOOST_AUTO_TEST_CASE(block_filter__header__genesis__expected)
+{
+    const auto filter = block_filter::compute(to_block(genesis_block), {});
+    const auto header = block_filter::header(filter, null_hash);
+    BOOST_REQUIRE_EQUAL(encode_hash(header),
+        "21584579b7eb08997773e5aeff3a7f932700042d0ed2a6129012b7d7ae81b750");
+}
+
+BOOST_AUTO_TEST_CASE(block_filter__header__chained__expected)
+{
+    const auto genesis = block_filter::compute(to_block(genesis_block), {});
+    const auto previous = block_filter::header(genesis, null_hash);
+    const data_stack prevouts
+    {
+        decode_chunk(duplicate_script), decode_chunk(spent_script), {}
+    };
+
+    const auto filter = block_filter::compute(to_block(excluded_block),
+        prevouts);
+    const auto header = block_filter::header(filter, previous);
+    BOOST_REQUIRE_EQUAL(encode_hash(header),
+        "2bdbc6187c9b0bdb60ab05960e0916793d9186346401f5621ac5f64483cb10e9");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
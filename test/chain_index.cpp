@@ -0,0 +1,241 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(chain_index_tests)
+
+// The node is not started, the index is linked directly.
+static const configuration configured(config::settings::mainnet);
+
+static constexpr size_t start_height = 10;
+
+// Record connected heights, retaining undo data for the given depth.
+class recorder
+  : public chain_index
+{
+public:
+    recorder(server_node& node, size_t undo_depth)
+      : chain_index(node, configured, "recorder", start_height, false),
+        resets(0), undo_depth_(undo_depth), undo_(0)
+    {
+    }
+
+    size_t append(const block_const_ptr_list& blocks, size_t first)
+    {
+        unique_lock lock(mutex_);
+        return link(blocks, first);
+    }
+
+    bool rollback(size_t fork_height, const block_const_ptr_list& old_blocks)
+    {
+        unique_lock lock(mutex_);
+        return unlink(fork_height, old_blocks);
+    }
+
+    std::vector<size_t> heights;
+    size_t resets;
+
+protected:
+    bool connect(block_const_ptr, size_t height) override
+    {
+        heights.push_back(height);
+        undo_ = std::min(undo_ + 1, undo_depth_);
+        return true;
+    }
+
+    bool disconnect(block_const_ptr, size_t height) override
+    {
+        if (undo_ == 0)
+            return false;
+
+        BOOST_REQUIRE_EQUAL(heights.back(), height);
+        heights.pop_back();
+        --undo_;
+        return true;
+    }
+
+    void reset() override
+    {
+        heights.clear();
+        undo_ = 0;
+        ++resets;
+    }
+
+private:
+    const size_t undo_depth_;
+    size_t undo_;
+};
+
+static block_const_ptr make_block(const hash_digest& previous, uint32_t nonce)
+{
+    return std::make_shared<const message::block>(
+        chain::header(1, previous, null_hash, 0, 0, nonce),
+        chain::transaction::list{});
+}
+
+// A branch of blocks from the previous hash, distinguished by the nonce.
+static block_const_ptr_list make_branch(const hash_digest& previous,
+    size_t count, uint32_t nonce)
+{
+    block_const_ptr_list blocks;
+    auto hash = previous;
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        blocks.push_back(make_block(hash, nonce));
+        hash = blocks.back()->header().hash();
+    }
+
+    return blocks;
+}
+
+static size_t top(const recorder& index)
+{
+    size_t height;
+    BOOST_REQUIRE(index.top(height));
+    return height;
+}
+
+BOOST_AUTO_TEST_CASE(chain_index__top__empty__false)
+{
+    server_node node(configured);
+    recorder index(node, 10);
+    size_t height;
+    BOOST_REQUIRE(!index.top(height));
+}
+
+BOOST_AUTO_TEST_CASE(chain_index__link__branch__connects_in_order)
+{
+    server_node node(configured);
+    recorder index(node, 10);
+    const auto blocks = make_branch(null_hash, 3, 0);
+
+    BOOST_REQUIRE_EQUAL(index.append(blocks, start_height), 3u);
+    BOOST_REQUIRE_EQUAL(top(index), start_height + 2);
+    BOOST_REQUIRE(index.heights == std::vector<size_t>({ 10, 11, 12 }));
+}
+
+BOOST_AUTO_TEST_CASE(chain_index__link__not_next_height__none)
+{
+    server_node node(configured);
+    recorder index(node, 10);
+    const auto blocks = make_branch(null_hash, 2, 0);
+
+    BOOST_REQUIRE_EQUAL(index.append(blocks, start_height + 1), 0u);
+    BOOST_REQUIRE(index.heights.empty());
+}
+
+BOOST_AUTO_TEST_CASE(chain_index__link__unlinked_previous__stops)
+{
+    server_node node(configured);
+    recorder index(node, 10);
+    auto blocks = make_branch(null_hash, 2, 0);
+    blocks.push_back(make_block(null_hash, 1));
+
+    BOOST_REQUIRE_EQUAL(index.append(blocks, start_height), 2u);
+    BOOST_REQUIRE_EQUAL(top(index), start_height + 1);
+}
+
+BOOST_AUTO_TEST_CASE(chain_index__link__window_after_window__continues)
+{
+    server_node node(configured);
+    recorder index(node, 10);
+    const auto blocks = make_branch(null_hash, 4, 0);
+    const block_const_ptr_list first(blocks.begin(), blocks.begin() + 2);
+    const block_const_ptr_list second(blocks.begin() + 2, blocks.end());
+
+    BOOST_REQUIRE_EQUAL(index.append(first, start_height), 2u);
+    BOOST_REQUIRE_EQUAL(index.append(second, start_height + 2), 2u);
+    BOOST_REQUIRE_EQUAL(top(index), start_height + 3);
+}
+
+BOOST_AUTO_TEST_CASE(chain_index__unlink__outgoing_top__disconnects_to_fork)
+{
+    server_node node(configured);
+    recorder index(node, 10);
+    const auto blocks = make_branch(null_hash, 3, 0);
+    BOOST_REQUIRE_EQUAL(index.append(blocks, start_height), 3u);
+
+    const block_const_ptr_list old_blocks(blocks.begin() + 1, blocks.end());
+    BOOST_REQUIRE(index.rollback(start_height, old_blocks));
+    BOOST_REQUIRE_EQUAL(top(index), start_height);
+    BOOST_REQUIRE(index.heights == std::vector<size_t>({ 10 }));
+
+    // The incoming branch links to the fork point.
+    const auto incoming = make_branch(blocks.front()->header().hash(), 3, 1);
+    BOOST_REQUIRE_EQUAL(index.append(incoming, start_height + 1), 3u);
+    BOOST_REQUIRE_EQUAL(top(index), start_height + 3);
+}
+
+BOOST_AUTO_TEST_CASE(chain_index__unlink__top_not_outgoing__unchanged)
+{
+    server_node node(configured);
+    recorder index(node, 10);
+    const auto blocks = make_branch(null_hash, 3, 0);
+    BOOST_REQUIRE_EQUAL(index.append(blocks, start_height), 3u);
+
+    // The top was read from the incoming branch after the reorganization.
+    const auto outgoing = make_branch(blocks.front()->header().hash(), 2, 1);
+    BOOST_REQUIRE(index.rollback(start_height, outgoing));
+    BOOST_REQUIRE_EQUAL(top(index), start_height + 2);
+    BOOST_REQUIRE_EQUAL(index.resets, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(chain_index__unlink__fork_above_top__unchanged)
+{
+    server_node node(configured);
+    recorder index(node, 10);
+    const auto blocks = make_branch(null_hash, 2, 0);
+    BOOST_REQUIRE_EQUAL(index.append(blocks, start_height), 2u);
+
+    const auto outgoing = make_branch(blocks.back()->header().hash(), 2, 1);
+    BOOST_REQUIRE(index.rollback(start_height + 1, outgoing));
+    BOOST_REQUIRE_EQUAL(top(index), start_height + 1);
+}
+
+BOOST_AUTO_TEST_CASE(chain_index__unlink__beyond_undo_depth__reset)
+{
+    server_node node(configured);
+    recorder index(node, 1);
+    const auto blocks = make_branch(null_hash, 3, 0);
+    BOOST_REQUIRE_EQUAL(index.append(blocks, start_height), 3u);
+
+    BOOST_REQUIRE(!index.rollback(start_height - 1, blocks));
+    BOOST_REQUIRE_EQUAL(index.resets, 1u);
+    BOOST_REQUIRE(index.heights.empty());
+
+    size_t height;
+    BOOST_REQUIRE(!index.top(height));
+
+    // The rebuild links from the start height without a previous block.
+    const auto incoming = make_branch(blocks.front()->header().hash(), 2, 1);
+    BOOST_REQUIRE_EQUAL(index.append(incoming, start_height), 2u);
+    BOOST_REQUIRE_EQUAL(top(index), start_height + 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,187 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(confirmation_watches_tests)
+
+typedef confirmation_watches::watch_ptr watch_ptr;
+typedef confirmation_watches::update_list update_list;
+
+// Transactions are distinguished by lock time.
+static chain::transaction make_tx(uint32_t locktime)
+{
+    return chain::transaction(1, locktime, chain::input::list{},
+        chain::output::list{});
+}
+
+static block_const_ptr make_block(const chain::transaction::list& transactions)
+{
+    return std::make_shared<const message::block>(chain::header{},
+        transactions);
+}
+
+static watch_ptr make_watch(uint32_t id, const hash_digest& tx_hash,
+    const std::vector<uint32_t>& depths)
+{
+    const auto expires = asio::steady_clock::now() + asio::seconds(60);
+    return std::make_shared<confirmation_watches::watch>(
+        confirmation_watches::watch{ {}, id, tx_hash, depths, expires, 0, 0 });
+}
+
+BOOST_AUTO_TEST_CASE(confirmation_watches__subscribe__at_limit__false)
+{
+    confirmation_watches watches;
+    const auto first = make_watch(1, make_tx(1).hash(), { 1 });
+    const auto second = make_watch(2, make_tx(2).hash(), { 1 });
+    BOOST_REQUIRE(watches.subscribe(first, 1));
+    BOOST_REQUIRE(!watches.subscribe(second, 1));
+    BOOST_REQUIRE_EQUAL(watches.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(confirmation_watches__subscribe__same_transaction__replaced)
+{
+    confirmation_watches watches;
+    const auto tx_hash = make_tx(1).hash();
+    BOOST_REQUIRE(watches.subscribe(make_watch(1, tx_hash, { 1 }), 1));
+    BOOST_REQUIRE(watches.subscribe(make_watch(2, tx_hash, { 1 }), 1));
+    BOOST_REQUIRE_EQUAL(watches.size(), 1u);
+
+    watches.unsubscribe({}, tx_hash);
+    BOOST_REQUIRE_EQUAL(watches.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(confirmation_watches__reorganize__depths__ordered_by_height)
+{
+    confirmation_watches watches;
+    const auto first = make_tx(1);
+    const auto second = make_tx(2);
+    BOOST_REQUIRE(watches.subscribe(make_watch(1, first.hash(), { 1, 3 }), 10));
+    BOOST_REQUIRE(watches.subscribe(make_watch(2, second.hash(), { 2 }), 10));
+
+    update_list updates;
+    watches.reorganize(100, { make_block({ first, second }) }, updates);
+    BOOST_REQUIRE_EQUAL(updates.size(), 1u);
+    BOOST_REQUIRE_EQUAL(updates[0].id, 1u);
+    BOOST_REQUIRE_EQUAL(updates[0].depth, 1u);
+    BOOST_REQUIRE_EQUAL(updates[0].height, 101u);
+
+    updates.clear();
+    watches.reorganize(101, { make_block({ make_tx(3) }) }, updates);
+    BOOST_REQUIRE_EQUAL(updates.size(), 1u);
+    BOOST_REQUIRE_EQUAL(updates[0].id, 2u);
+    BOOST_REQUIRE_EQUAL(updates[0].depth, 2u);
+    BOOST_REQUIRE_EQUAL(watches.size(), 1u);
+
+    updates.clear();
+    watches.reorganize(102, { make_block({ make_tx(4) }) }, updates);
+    BOOST_REQUIRE_EQUAL(updates.size(), 1u);
+    BOOST_REQUIRE_EQUAL(updates[0].id, 1u);
+    BOOST_REQUIRE_EQUAL(updates[0].depth, 3u);
+    BOOST_REQUIRE_EQUAL(updates[0].height, 101u);
+    BOOST_REQUIRE_EQUAL(watches.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(confirmation_watches__locate__depths_reached_together__notified_together)
+{
+    confirmation_watches watches;
+    const auto located = make_watch(1, make_tx(1).hash(), { 1, 2, 3 });
+    BOOST_REQUIRE(watches.subscribe(located, 10));
+
+    update_list updates;
+    watches.locate(located, 100, 101, updates);
+    BOOST_REQUIRE_EQUAL(updates.size(), 2u);
+    BOOST_REQUIRE_EQUAL(updates[0].depth, 1u);
+    BOOST_REQUIRE_EQUAL(updates[1].depth, 2u);
+    BOOST_REQUIRE_EQUAL(updates[1].height, 100u);
+    BOOST_REQUIRE_EQUAL(watches.size(), 1u);
+
+    // A located watch is no longer unconfirmed, so is not located again.
+    updates.clear();
+    watches.locate(located, 100, 101, updates);
+    BOOST_REQUIRE(updates.empty());
+}
+
+BOOST_AUTO_TEST_CASE(confirmation_watches__reorganize__above_confirmation__reset_and_reconfirmed)
+{
+    confirmation_watches watches;
+    const auto watched = make_tx(1);
+    const auto watching = make_watch(1, watched.hash(), { 1, 2 });
+    BOOST_REQUIRE(watches.subscribe(watching, 10));
+
+    update_list updates;
+    watches.reorganize(100, { make_block({ watched }) }, updates);
+    BOOST_REQUIRE_EQUAL(updates.size(), 1u);
+    BOOST_REQUIRE_EQUAL(updates[0].height, 101u);
+
+    // The confirming block is replaced and the transaction confirmed above.
+    updates.clear();
+    watches.reorganize(100,
+        { make_block({ make_tx(2) }), make_block({ watched }) }, updates);
+    BOOST_REQUIRE_EQUAL(updates.size(), 2u);
+    BOOST_REQUIRE_EQUAL(updates[0].depth, 0u);
+    BOOST_REQUIRE_EQUAL(updates[0].height, 0u);
+    BOOST_REQUIRE_EQUAL(updates[1].depth, 1u);
+    BOOST_REQUIRE_EQUAL(updates[1].height, 102u);
+    BOOST_REQUIRE_EQUAL(watches.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(confirmation_watches__reorganize__above_fork__not_reset)
+{
+    confirmation_watches watches;
+    const auto watched = make_tx(1);
+    const auto watching = make_watch(1, watched.hash(), { 1, 2 });
+    BOOST_REQUIRE(watches.subscribe(watching, 10));
+
+    update_list updates;
+    watches.reorganize(100, { make_block({ watched }) }, updates);
+    BOOST_REQUIRE_EQUAL(updates.size(), 1u);
+
+    updates.clear();
+    watches.reorganize(101, { make_block({ make_tx(2) }) }, updates);
+    BOOST_REQUIRE_EQUAL(updates.size(), 1u);
+    BOOST_REQUIRE_EQUAL(updates[0].depth, 2u);
+    BOOST_REQUIRE_EQUAL(updates[0].height, 101u);
+    BOOST_REQUIRE_EQUAL(watches.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(confirmation_watches__purge__expired__timed_out)
+{
+    confirmation_watches watches;
+    const auto expiring = make_watch(1, make_tx(1).hash(), { 1 });
+    BOOST_REQUIRE(watches.subscribe(expiring, 10));
+
+    update_list updates;
+    watches.purge(asio::steady_clock::now(), updates);
+    BOOST_REQUIRE(updates.empty());
+
+    watches.purge(asio::steady_clock::now() + asio::seconds(61), updates);
+    BOOST_REQUIRE_EQUAL(updates.size(), 1u);
+    BOOST_REQUIRE(updates[0].ec == error::channel_timeout);
+    BOOST_REQUIRE_EQUAL(watches.size(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
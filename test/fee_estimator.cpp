@@ -0,0 +1,201 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace boost::filesystem;
+
+BOOST_AUTO_TEST_SUITE(fee_estimator_tests)
+
+// The node is not started, the estimator is updated directly.
+static const configuration configured(config::settings::mainnet);
+
+static constexpr uint64_t rate = 1000;
+static constexpr size_t top_height = 100;
+
+// Each test saves its statistics to a new temporary database directory.
+struct directory_fixture
+{
+    directory_fixture()
+      : settings(configured)
+    {
+        settings.server.fee_estimator_save_blocks = 0;
+        settings.database.directory = temp_directory_path() /
+            unique_path("fee_estimator_%%%%-%%%%-%%%%");
+        create_directories(settings.database.directory);
+    }
+
+    ~directory_fixture()
+    {
+        boost::system::error_code ec;
+        remove_all(settings.database.directory, ec);
+    }
+
+    path file() const
+    {
+        return settings.database.directory / "fee_estimator";
+    }
+
+    configuration settings;
+};
+
+// Transactions are distinguished by lock time.
+static chain::transaction make_tx(uint32_t locktime)
+{
+    return chain::transaction(1, locktime, chain::input::list{},
+        chain::output::list{});
+}
+
+static block_const_ptr make_block(const chain::transaction::list& transactions)
+{
+    return std::make_shared<const message::block>(chain::header{},
+        transactions);
+}
+
+// Confirm a transaction of the rate in the block after it is pooled.
+static void confirm(fee_estimator& estimator, uint32_t locktime)
+{
+    const auto tx = make_tx(locktime);
+    estimator.reorganize(top_height - 1, { make_block({}) });
+    estimator.add(tx.hash(), rate);
+    estimator.reorganize(top_height, { make_block({ tx }) });
+}
+
+static uint64_t expected()
+{
+    return fee_histogram::bounds[fee_histogram::bucket_index(rate)];
+}
+
+BOOST_FIXTURE_TEST_CASE(fee_estimator__estimate__no_samples__false,
+    directory_fixture)
+{
+    server_node node(configured);
+    fee_estimator estimator(node, settings);
+    uint64_t estimate;
+    BOOST_REQUIRE(!estimator.estimate(1, estimate));
+}
+
+BOOST_FIXTURE_TEST_CASE(fee_estimator__estimate__confirmed_in_one__bucket_rate,
+    directory_fixture)
+{
+    server_node node(configured);
+    fee_estimator estimator(node, settings);
+    confirm(estimator, 1);
+
+    uint64_t estimate;
+    BOOST_REQUIRE(estimator.estimate(1, estimate));
+    BOOST_REQUIRE_EQUAL(estimate, expected());
+    BOOST_REQUIRE(!estimator.estimate(0, estimate));
+    BOOST_REQUIRE(!estimator.estimate(fee_estimator::max_target + 1,
+        estimate));
+}
+
+BOOST_FIXTURE_TEST_CASE(fee_estimator__add__before_top__not_tracked,
+    directory_fixture)
+{
+    server_node node(configured);
+    fee_estimator estimator(node, settings);
+    const auto tx = make_tx(1);
+    estimator.add(tx.hash(), rate);
+    estimator.reorganize(top_height, { make_block({ tx }) });
+
+    uint64_t estimate;
+    BOOST_REQUIRE(!estimator.estimate(1, estimate));
+}
+
+BOOST_FIXTURE_TEST_CASE(fee_estimator__load__no_file__false,
+    directory_fixture)
+{
+    server_node node(configured);
+    fee_estimator estimator(node, settings);
+    BOOST_REQUIRE(!estimator.load());
+}
+
+BOOST_FIXTURE_TEST_CASE(fee_estimator__load__saved__round_trip,
+    directory_fixture)
+{
+    server_node node(configured);
+
+    {
+        fee_estimator estimator(node, settings);
+        confirm(estimator, 1);
+        BOOST_REQUIRE(estimator.save());
+    }
+
+    BOOST_REQUIRE(!exists(file().string() + ".tmp"));
+
+    fee_estimator estimator(node, settings);
+    uint64_t estimate;
+    BOOST_REQUIRE(!estimator.estimate(1, estimate));
+    BOOST_REQUIRE(estimator.load());
+    BOOST_REQUIRE(estimator.estimate(1, estimate));
+    BOOST_REQUIRE_EQUAL(estimate, expected());
+}
+
+BOOST_FIXTURE_TEST_CASE(fee_estimator__reorganize__save_interval__saved,
+    directory_fixture)
+{
+    server_node node(configured);
+    settings.server.fee_estimator_save_blocks = 2;
+
+    {
+        fee_estimator estimator(node, settings);
+        confirm(estimator, 1);
+    }
+
+    fee_estimator estimator(node, settings);
+    BOOST_REQUIRE(estimator.load());
+
+    uint64_t estimate;
+    BOOST_REQUIRE(estimator.estimate(1, estimate));
+    BOOST_REQUIRE_EQUAL(estimate, expected());
+}
+
+BOOST_FIXTURE_TEST_CASE(fee_estimator__load__other_dimensions__false,
+    directory_fixture)
+{
+    server_node node(configured);
+
+    {
+        fee_estimator estimator(node, settings);
+        confirm(estimator, 1);
+        BOOST_REQUIRE(estimator.save());
+    }
+
+    // Change the bucket count of the saved statistics.
+    std::fstream stream(file().string(),
+        std::ios::binary | std::ios::in | std::ios::out);
+    stream.put(static_cast<char>(fee_histogram::buckets + 1));
+    stream.close();
+
+    fee_estimator estimator(node, settings);
+    BOOST_REQUIRE(!estimator.load());
+
+    uint64_t estimate;
+    BOOST_REQUIRE(!estimator.estimate(1, estimate));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(fee_histogram_tests)
+
+// The node is not started, it only provides the subscribers.
+static const configuration configured(config::settings::mainnet);
+
+static hash_digest key(uint8_t value)
+{
+    hash_digest hash{};
+    hash.front() = value;
+    return hash;
+}
+
+// The transaction count and bytes of the bucket.
+static std::pair<uint32_t, uint64_t> row(const fee_histogram& histogram,
+    size_t bucket)
+{
+    static constexpr size_t row_size = sizeof(uint32_t) + sizeof(uint32_t) +
+        sizeof(uint64_t);
+
+    const auto data = histogram.to_data();
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    deserial.skip(sizeof(uint8_t) + bucket * row_size + sizeof(uint32_t));
+    const auto transactions = deserial.read_4_bytes_little_endian();
+    const auto bytes = deserial.read_8_bytes_little_endian();
+    BOOST_REQUIRE(deserial);
+    return { transactions, bytes };
+}
+
+BOOST_AUTO_TEST_CASE(fee_histogram__bounds__ascending)
+{
+    const auto& bounds = fee_histogram::bounds;
+    BOOST_REQUIRE_EQUAL(bounds.front(), 0u);
+    BOOST_REQUIRE(std::is_sorted(bounds.begin(), bounds.end()));
+    BOOST_REQUIRE(std::adjacent_find(bounds.begin(), bounds.end()) ==
+        bounds.end());
+}
+
+BOOST_AUTO_TEST_CASE(fee_histogram__bucket_index__zero__first)
+{
+    BOOST_REQUIRE_EQUAL(fee_histogram::bucket_index(0), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(fee_histogram__bucket_index__bound__bucket_of_bound)
+{
+    BOOST_REQUIRE_EQUAL(fee_histogram::bucket_index(1), 1u);
+    BOOST_REQUIRE_EQUAL(fee_histogram::bucket_index(8), 7u);
+    BOOST_REQUIRE_EQUAL(fee_histogram::bucket_index(5000), 31u);
+}
+
+BOOST_AUTO_TEST_CASE(fee_histogram__bucket_index__between_bounds__lower_bucket)
+{
+    BOOST_REQUIRE_EQUAL(fee_histogram::bucket_index(7), 6u);
+    BOOST_REQUIRE_EQUAL(fee_histogram::bucket_index(4999), 30u);
+}
+
+BOOST_AUTO_TEST_CASE(fee_histogram__bucket_index__maximum__last)
+{
+    BOOST_REQUIRE_EQUAL(fee_histogram::bucket_index(max_uint64),
+        fee_histogram::buckets - 1);
+}
+
+BOOST_AUTO_TEST_CASE(fee_histogram__bucket_index__every_bound__own_bucket)
+{
+    for (size_t bucket = 0; bucket < fee_histogram::buckets; ++bucket)
+        BOOST_REQUIRE_EQUAL(fee_histogram::bucket_index(
+            fee_histogram::bounds[bucket]), bucket);
+}
+
+BOOST_AUTO_TEST_CASE(fee_histogram__add__distinct__counted_in_bucket)
+{
+    server_node node(configured);
+    fee_histogram histogram(node, asio::seconds(60));
+    const auto expiry = asio::steady_clock::now() + asio::seconds(60);
+    histogram.add(key(1), 9, 100, expiry);
+    histogram.add(key(2), 8, 200, expiry);
+    histogram.add(key(2), 8, 200, expiry);
+
+    const auto counted = row(histogram, fee_histogram::bucket_index(8));
+    BOOST_REQUIRE_EQUAL(counted.first, 2u);
+    BOOST_REQUIRE_EQUAL(counted.second, 300u);
+}
+
+BOOST_AUTO_TEST_CASE(fee_histogram__remove__counted__uncounted)
+{
+    server_node node(configured);
+    fee_histogram histogram(node, asio::seconds(60));
+    const auto expiry = asio::steady_clock::now() + asio::seconds(60);
+    histogram.add(key(1), 8, 100, expiry);
+    histogram.remove(key(1));
+    histogram.remove(key(2));
+
+    const auto counted = row(histogram, fee_histogram::bucket_index(8));
+    BOOST_REQUIRE_EQUAL(counted.first, 0u);
+    BOOST_REQUIRE_EQUAL(counted.second, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(fee_histogram__purge__expired__uncounted)
+{
+    server_node node(configured);
+    fee_histogram histogram(node, asio::seconds(60));
+    const auto now = asio::steady_clock::now();
+    histogram.add(key(1), 8, 100, now + asio::seconds(1));
+    histogram.add(key(2), 8, 200, now + asio::seconds(2));
+
+    histogram.purge(now);
+    BOOST_REQUIRE_EQUAL(row(histogram, 7).first, 2u);
+
+    histogram.purge(now + asio::seconds(1));
+    const auto counted = row(histogram, 7);
+    BOOST_REQUIRE_EQUAL(counted.first, 1u);
+    BOOST_REQUIRE_EQUAL(counted.second, 200u);
+}
+
+BOOST_AUTO_TEST_CASE(fee_histogram__purge__removed_and_restored__not_uncounted)
+{
+    server_node node(configured);
+    fee_histogram histogram(node, asio::seconds(60));
+    const auto now = asio::steady_clock::now();
+    histogram.add(key(1), 8, 100, now + asio::seconds(1));
+    histogram.remove(key(1));
+    histogram.add(key(1), 8, 100, now + asio::seconds(2));
+
+    // The original expiry no longer applies to the restored transaction.
+    histogram.purge(now + asio::seconds(1));
+    BOOST_REQUIRE_EQUAL(row(histogram, 7).first, 1u);
+
+    histogram.purge(now + asio::seconds(2));
+    BOOST_REQUIRE_EQUAL(row(histogram, 7).first, 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
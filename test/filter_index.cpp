@@ -0,0 +1,242 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace boost::filesystem;
+
+BOOST_AUTO_TEST_SUITE(filter_index_tests)
+
+// The node is not started, the index is loaded, prepared and linked directly.
+static const configuration configured(config::settings::mainnet);
+
+// Each test persists its index to a new temporary database directory.
+struct directory_fixture
+{
+    directory_fixture()
+      : settings(configured)
+    {
+        settings.database.directory = temp_directory_path() /
+            unique_path("filter_index_%%%%-%%%%-%%%%");
+        create_directories(settings.database.directory);
+    }
+
+    ~directory_fixture()
+    {
+        boost::system::error_code ec;
+        remove_all(settings.database.directory, ec);
+    }
+
+    path file() const
+    {
+        return settings.database.directory / "filter_index";
+    }
+
+    configuration settings;
+};
+
+// Blocks have only a coinbase, so prepare completes in place.
+class indexer
+  : public filter_index
+{
+public:
+    indexer(server_node& node, const configuration& settings)
+      : filter_index(node, settings),
+        start_height_(settings.database.index_start_height)
+    {
+    }
+
+    size_t restore(hash_digest& top_hash)
+    {
+        return load(top_hash);
+    }
+
+    size_t append(const block_const_ptr_list& blocks)
+    {
+        for (size_t index = 0; index < blocks.size(); ++index)
+        {
+            auto prepared = false;
+            prepare(blocks[index], start_height_ + index,
+                [&](const code& ec) { prepared = !ec; });
+            BOOST_REQUIRE(prepared);
+        }
+
+        unique_lock lock(mutex_);
+        return link(blocks, start_height_);
+    }
+
+    bool rollback(size_t fork_height, block_const_ptr block)
+    {
+        unique_lock lock(mutex_);
+        return unlink(fork_height, { block });
+    }
+
+private:
+    const size_t start_height_;
+};
+
+// Coinbase transactions are distinguished by height.
+static block_const_ptr_list make_blocks(size_t count)
+{
+    block_const_ptr_list blocks;
+    auto previous = null_hash;
+
+    for (uint32_t height = 0; height < count; ++height)
+    {
+        const chain::input input(chain::output_point(null_hash,
+            chain::point::null_index), chain::script{}, height);
+        const chain::output output(50, chain::script(
+            chain::script::to_pay_key_hash_pattern(short_hash{})));
+        const chain::transaction coinbase(1, 0, { input }, { output });
+
+        blocks.push_back(std::make_shared<const message::block>(
+            chain::header(1, previous, null_hash, 0, 0, 0),
+            chain::transaction::list{ coinbase }));
+        previous = blocks.back()->header().hash();
+    }
+
+    return blocks;
+}
+
+static filter_index::filter_list filters(const filter_index& index)
+{
+    filter_index::filter_list out;
+    BOOST_REQUIRE(index.filters(configured.database.index_start_height, 10,
+        out));
+    return out;
+}
+
+BOOST_FIXTURE_TEST_CASE(filter_index__load__no_file__none, directory_fixture)
+{
+    server_node node(configured);
+    indexer index(node, settings);
+    auto top_hash = null_hash;
+    BOOST_REQUIRE_EQUAL(index.restore(top_hash), 0u);
+    BOOST_REQUIRE(top_hash == null_hash);
+    BOOST_REQUIRE(exists(file()));
+}
+
+BOOST_FIXTURE_TEST_CASE(filter_index__load__restart__restored,
+    directory_fixture)
+{
+    server_node node(configured);
+    const auto blocks = make_blocks(3);
+    filter_index::filter_list expected;
+
+    {
+        indexer index(node, settings);
+        auto top_hash = null_hash;
+        BOOST_REQUIRE_EQUAL(index.restore(top_hash), 0u);
+        BOOST_REQUIRE_EQUAL(index.append(blocks), 3u);
+        expected = filters(index);
+    }
+
+    indexer index(node, settings);
+    auto top_hash = null_hash;
+    BOOST_REQUIRE_EQUAL(index.restore(top_hash), 3u);
+    BOOST_REQUIRE(top_hash == blocks.back()->header().hash());
+
+    const auto restored = filters(index);
+    BOOST_REQUIRE_EQUAL(restored.size(), expected.size());
+
+    for (size_t row = 0; row < restored.size(); ++row)
+    {
+        BOOST_REQUIRE(restored[row].block_hash == expected[row].block_hash);
+        BOOST_REQUIRE(restored[row].filter_header ==
+            expected[row].filter_header);
+        BOOST_REQUIRE(restored[row].filter == expected[row].filter);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(filter_index__load__partial_record__dropped,
+    directory_fixture)
+{
+    server_node node(configured);
+    const auto blocks = make_blocks(2);
+
+    {
+        indexer index(node, settings);
+        auto top_hash = null_hash;
+        BOOST_REQUIRE_EQUAL(index.restore(top_hash), 0u);
+        BOOST_REQUIRE_EQUAL(index.append(blocks), 2u);
+    }
+
+    // Simulate a write interrupted within the next record.
+    const auto size = file_size(file());
+    std::ofstream stream(file().string(), std::ios::binary | std::ios::app);
+    stream.write("\x01\x02\x03", 3);
+    stream.close();
+
+    indexer index(node, settings);
+    auto top_hash = null_hash;
+    BOOST_REQUIRE_EQUAL(index.restore(top_hash), 2u);
+    BOOST_REQUIRE(top_hash == blocks.back()->header().hash());
+    BOOST_REQUIRE_EQUAL(file_size(file()), size);
+}
+
+BOOST_FIXTURE_TEST_CASE(filter_index__load__disconnected__truncated,
+    directory_fixture)
+{
+    server_node node(configured);
+    const auto blocks = make_blocks(3);
+    const auto start_height = settings.database.index_start_height;
+
+    {
+        indexer index(node, settings);
+        auto top_hash = null_hash;
+        BOOST_REQUIRE_EQUAL(index.restore(top_hash), 0u);
+        BOOST_REQUIRE_EQUAL(index.append(blocks), 3u);
+        BOOST_REQUIRE(index.rollback(start_height + 1, blocks.back()));
+        BOOST_REQUIRE_EQUAL(filters(index).size(), 2u);
+    }
+
+    indexer index(node, settings);
+    auto top_hash = null_hash;
+    BOOST_REQUIRE_EQUAL(index.restore(top_hash), 2u);
+    BOOST_REQUIRE(top_hash == blocks[1]->header().hash());
+}
+
+BOOST_FIXTURE_TEST_CASE(filter_index__load__other_start_height__discarded,
+    directory_fixture)
+{
+    server_node node(configured);
+
+    {
+        indexer index(node, settings);
+        auto top_hash = null_hash;
+        BOOST_REQUIRE_EQUAL(index.restore(top_hash), 0u);
+        BOOST_REQUIRE_EQUAL(index.append(make_blocks(2)), 2u);
+    }
+
+    auto other = settings;
+    other.database.index_start_height += 1;
+    indexer index(node, other);
+    auto top_hash = null_hash;
+    BOOST_REQUIRE_EQUAL(index.restore(top_hash), 0u);
+    BOOST_REQUIRE(top_hash == null_hash);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
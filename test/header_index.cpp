@@ -0,0 +1,168 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(header_index_tests)
+
+// The node is not started, the index is linked directly.
+static const configuration configured(config::settings::mainnet);
+
+class indexer
+  : public header_index
+{
+public:
+    indexer(server_node& node)
+      : header_index(node, configured)
+    {
+    }
+
+    size_t append(const block_const_ptr_list& blocks, size_t first)
+    {
+        unique_lock lock(mutex_);
+        return link(blocks, first);
+    }
+
+    bool rollback(size_t fork_height, const block_const_ptr_list& old_blocks)
+    {
+        unique_lock lock(mutex_);
+        return unlink(fork_height, old_blocks);
+    }
+};
+
+// Headers are connected as blocks without transactions, one per timestamp.
+static block_const_ptr_list make_headers(
+    const std::vector<uint32_t>& timestamps)
+{
+    block_const_ptr_list blocks;
+    auto previous = null_hash;
+
+    for (const auto timestamp: timestamps)
+    {
+        blocks.push_back(std::make_shared<const message::block>(
+            chain::header(1, previous, null_hash, timestamp, 0, 0),
+            chain::transaction::list{}));
+        previous = blocks.back()->header().hash();
+    }
+
+    return blocks;
+}
+
+BOOST_AUTO_TEST_CASE(header_index__headers__empty__false)
+{
+    server_node node(configured);
+    indexer index(node);
+    data_chunk out;
+    size_t appended;
+    BOOST_REQUIRE(!index.headers(0, 1, out, appended));
+}
+
+BOOST_AUTO_TEST_CASE(header_index__headers__connected__serialized_in_order)
+{
+    server_node node(configured);
+    indexer index(node);
+    const auto blocks = make_headers({ 100, 200, 300 });
+    BOOST_REQUIRE_EQUAL(index.append(blocks, 0), 3u);
+
+    data_chunk out;
+    size_t appended;
+    BOOST_REQUIRE(index.headers(0, 10, out, appended));
+    BOOST_REQUIRE_EQUAL(appended, 3u);
+
+    data_chunk expected;
+    for (const auto block: blocks)
+        extend_data(expected, block->header().to_data());
+
+    BOOST_REQUIRE(out == expected);
+}
+
+BOOST_AUTO_TEST_CASE(header_index__headers__from_height__count_limited)
+{
+    server_node node(configured);
+    indexer index(node);
+    const auto blocks = make_headers({ 100, 200, 300 });
+    BOOST_REQUIRE_EQUAL(index.append(blocks, 0), 3u);
+
+    data_chunk out;
+    size_t appended;
+    BOOST_REQUIRE(index.headers(1, 1, out, appended));
+    BOOST_REQUIRE_EQUAL(appended, 1u);
+    BOOST_REQUIRE(out == blocks[1]->header().to_data());
+    BOOST_REQUIRE(!index.headers(3, 1, out, appended));
+}
+
+BOOST_AUTO_TEST_CASE(header_index__headers__disconnected__truncated)
+{
+    server_node node(configured);
+    indexer index(node);
+    const auto blocks = make_headers({ 100, 200, 300 });
+    BOOST_REQUIRE_EQUAL(index.append(blocks, 0), 3u);
+
+    const block_const_ptr_list old_blocks(blocks.begin() + 1, blocks.end());
+    BOOST_REQUIRE(index.rollback(0, old_blocks));
+
+    data_chunk out;
+    size_t appended;
+    BOOST_REQUIRE(!index.headers(1, 1, out, appended));
+    BOOST_REQUIRE(index.headers(0, 10, out, appended));
+    BOOST_REQUIRE_EQUAL(appended, 1u);
+    BOOST_REQUIRE(out == blocks[0]->header().to_data());
+}
+
+// Median times past of 100, 200 and 200 for these timestamps.
+BOOST_AUTO_TEST_CASE(header_index__height_by_time__median__first_at_or_after)
+{
+    server_node node(configured);
+    indexer index(node);
+    BOOST_REQUIRE_EQUAL(index.append(make_headers({ 100, 200, 300 }), 0), 3u);
+
+    size_t height;
+    BOOST_REQUIRE(index.height_by_time(0, height));
+    BOOST_REQUIRE_EQUAL(height, 0u);
+    BOOST_REQUIRE(index.height_by_time(150, height));
+    BOOST_REQUIRE_EQUAL(height, 1u);
+    BOOST_REQUIRE(index.height_by_time(200, height));
+    BOOST_REQUIRE_EQUAL(height, 1u);
+    BOOST_REQUIRE(!index.height_by_time(201, height));
+}
+
+BOOST_AUTO_TEST_CASE(header_index__height_by_time__disconnected__truncated)
+{
+    server_node node(configured);
+    indexer index(node);
+    const auto blocks = make_headers({ 100, 200, 300 });
+    BOOST_REQUIRE_EQUAL(index.append(blocks, 0), 3u);
+
+    const block_const_ptr_list old_blocks(blocks.begin() + 1, blocks.end());
+    BOOST_REQUIRE(index.rollback(0, old_blocks));
+
+    size_t height;
+    BOOST_REQUIRE(!index.height_by_time(150, height));
+    BOOST_REQUIRE(index.height_by_time(100, height));
+    BOOST_REQUIRE_EQUAL(height, 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
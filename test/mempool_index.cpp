@@ -0,0 +1,183 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(mempool_index_tests)
+
+// The node is not started, it only provides the subscribers.
+static const configuration configured(config::settings::mainnet);
+static const auto lifetime = asio::seconds(60);
+
+static short_hash address(uint8_t key)
+{
+    short_hash hash{};
+    hash.front() = key;
+    return hash;
+}
+
+static chain::output pay(uint64_t value, uint8_t key)
+{
+    return chain::output(value,
+        chain::script(chain::script::to_pay_key_hash_pattern(address(key))));
+}
+
+// Transactions are distinguished by the sequence of their one input.
+static chain::transaction make_tx(uint32_t sequence, uint64_t value,
+    uint8_t key)
+{
+    const chain::input input(chain::output_point(null_hash, 0),
+        chain::script{}, sequence);
+    return chain::transaction(1, 0, { input }, { pay(value, key) });
+}
+
+static chain::transaction coinbase(uint8_t key)
+{
+    const chain::input input(chain::output_point(null_hash,
+        chain::point::null_index), chain::script{}, 0);
+    return chain::transaction(1, 0, { input }, { pay(50, key) });
+}
+
+static block_const_ptr make_block(chain::transaction::list&& transactions)
+{
+    return std::make_shared<const message::block>(chain::header{},
+        std::move(transactions));
+}
+
+static chain::history_compact::list history(const mempool_index& index,
+    uint8_t key)
+{
+    chain::history_compact::list out;
+    index.history(address(key), out);
+    return out;
+}
+
+BOOST_AUTO_TEST_CASE(mempool_index__history__added__unconfirmed_output)
+{
+    server_node node(configured);
+    mempool_index index(node, lifetime);
+    const auto tx = make_tx(1, 42, 1);
+    index.add(tx, asio::steady_clock::now() + lifetime);
+
+    const auto rows = history(index, 1);
+    BOOST_REQUIRE_EQUAL(rows.size(), 1u);
+    BOOST_REQUIRE(rows[0].kind == chain::point_kind::output);
+    BOOST_REQUIRE(rows[0].point == chain::point(tx.hash(), 0));
+    BOOST_REQUIRE_EQUAL(rows[0].height, 0u);
+    BOOST_REQUIRE_EQUAL(rows[0].value, 42u);
+    BOOST_REQUIRE(history(index, 2).empty());
+}
+
+BOOST_AUTO_TEST_CASE(mempool_index__history__added_twice__one_row)
+{
+    server_node node(configured);
+    mempool_index index(node, lifetime);
+    const auto tx = make_tx(1, 42, 1);
+    index.add(tx, asio::steady_clock::now() + lifetime);
+    index.add(tx, asio::steady_clock::now() + lifetime);
+    BOOST_REQUIRE_EQUAL(history(index, 1).size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(mempool_index__remove__added__removed)
+{
+    server_node node(configured);
+    mempool_index index(node, lifetime);
+    const auto first = make_tx(1, 42, 1);
+    const auto second = make_tx(2, 24, 1);
+    index.add(first, asio::steady_clock::now() + lifetime);
+    index.add(second, asio::steady_clock::now() + lifetime);
+
+    index.remove(first.hash());
+    const auto rows = history(index, 1);
+    BOOST_REQUIRE_EQUAL(rows.size(), 1u);
+    BOOST_REQUIRE(rows[0].point == chain::point(second.hash(), 0));
+}
+
+BOOST_AUTO_TEST_CASE(mempool_index__purge__expired__removed)
+{
+    server_node node(configured);
+    mempool_index index(node, lifetime);
+    const auto now = asio::steady_clock::now();
+    index.add(make_tx(1, 42, 1), now);
+    index.add(make_tx(2, 24, 2), now + lifetime);
+
+    index.purge(now);
+    BOOST_REQUIRE(history(index, 1).empty());
+    BOOST_REQUIRE_EQUAL(history(index, 2).size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(mempool_index__purge__restored_after_remove__retained)
+{
+    server_node node(configured);
+    mempool_index index(node, lifetime);
+    const auto now = asio::steady_clock::now();
+    const auto tx = make_tx(1, 42, 1);
+    index.add(tx, now);
+    index.remove(tx.hash());
+    index.add(tx, now + lifetime);
+
+    index.purge(now);
+    BOOST_REQUIRE_EQUAL(history(index, 1).size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(mempool_index__reorganize__confirmed__removed)
+{
+    server_node node(configured);
+    mempool_index index(node, lifetime);
+    const auto now = asio::steady_clock::now();
+    const auto tx = make_tx(1, 42, 1);
+    index.add(tx, now + lifetime);
+
+    index.reorganize({ make_block({ coinbase(1), tx }) }, {}, now);
+    BOOST_REQUIRE(history(index, 1).empty());
+}
+
+BOOST_AUTO_TEST_CASE(mempool_index__reorganize__outgoing__restored_except_coinbase)
+{
+    server_node node(configured);
+    mempool_index index(node, lifetime);
+    const auto now = asio::steady_clock::now();
+    const auto tx = make_tx(1, 42, 1);
+    const auto outgoing = make_block({ coinbase(1), tx });
+
+    index.reorganize({ make_block({ coinbase(2) }) }, { outgoing }, now);
+    const auto rows = history(index, 1);
+    BOOST_REQUIRE_EQUAL(rows.size(), 1u);
+    BOOST_REQUIRE(rows[0].point == chain::point(tx.hash(), 0));
+    BOOST_REQUIRE(history(index, 2).empty());
+}
+
+BOOST_AUTO_TEST_CASE(mempool_index__reorganize__expired__removed)
+{
+    server_node node(configured);
+    mempool_index index(node, lifetime);
+    const auto now = asio::steady_clock::now();
+    index.add(make_tx(1, 42, 1), now);
+
+    index.reorganize({ make_block({ coinbase(2) }) }, {}, now);
+    BOOST_REQUIRE(history(index, 1).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
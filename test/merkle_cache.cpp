@@ -0,0 +1,165 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(merkle_cache_tests)
+
+// The node is not started, it only provides the reorganization subscriber.
+static const configuration configured(config::settings::mainnet);
+
+static hash_digest leaf(uint8_t value)
+{
+    hash_digest hash{};
+    hash.front() = value;
+    return hash;
+}
+
+static hash_digest join(const hash_digest& left, const hash_digest& right)
+{
+    return bitcoin_hash(build_chunk({ left, right }));
+}
+
+// Fold the branch of the leaf at the position into its root.
+static hash_digest fold(hash_digest hash, size_t position,
+    const hash_list& branch)
+{
+    for (const auto& sibling: branch)
+    {
+        hash = (position & 1) == 0 ? join(hash, sibling) : join(sibling, hash);
+        position >>= 1;
+    }
+
+    return hash;
+}
+
+BOOST_AUTO_TEST_CASE(merkle_cache__build__empty__empty)
+{
+    const auto tree = merkle_cache::build({});
+    BOOST_REQUIRE(tree->empty());
+    BOOST_REQUIRE(merkle_cache::branch(*tree, 0).empty());
+}
+
+BOOST_AUTO_TEST_CASE(merkle_cache__build__single__root_is_leaf)
+{
+    const auto tree = merkle_cache::build({ leaf(1) });
+    BOOST_REQUIRE_EQUAL(tree->size(), 1u);
+    BOOST_REQUIRE(tree->back().front() == leaf(1));
+    BOOST_REQUIRE(merkle_cache::branch(*tree, 0).empty());
+}
+
+BOOST_AUTO_TEST_CASE(merkle_cache__build__odd__last_paired_with_self)
+{
+    const auto a = leaf(1);
+    const auto b = leaf(2);
+    const auto c = leaf(3);
+    const auto tree = merkle_cache::build({ a, b, c });
+
+    BOOST_REQUIRE_EQUAL(tree->size(), 3u);
+    BOOST_REQUIRE(tree->back().front() == join(join(a, b), join(c, c)));
+}
+
+BOOST_AUTO_TEST_CASE(merkle_cache__branch__first__expected)
+{
+    const auto a = leaf(1);
+    const auto b = leaf(2);
+    const auto c = leaf(3);
+    const auto tree = merkle_cache::build({ a, b, c });
+    const auto branch = merkle_cache::branch(*tree, 0);
+
+    BOOST_REQUIRE_EQUAL(branch.size(), 2u);
+    BOOST_REQUIRE(branch[0] == b);
+    BOOST_REQUIRE(branch[1] == join(c, c));
+}
+
+BOOST_AUTO_TEST_CASE(merkle_cache__branch__odd_last__sibling_is_self)
+{
+    const auto a = leaf(1);
+    const auto b = leaf(2);
+    const auto c = leaf(3);
+    const auto tree = merkle_cache::build({ a, b, c });
+    const auto branch = merkle_cache::branch(*tree, 2);
+
+    BOOST_REQUIRE_EQUAL(branch.size(), 2u);
+    BOOST_REQUIRE(branch[0] == c);
+    BOOST_REQUIRE(branch[1] == join(a, b));
+}
+
+BOOST_AUTO_TEST_CASE(merkle_cache__branch__all_positions__fold_to_root)
+{
+    const hash_list leaves{ leaf(1), leaf(2), leaf(3), leaf(4), leaf(5) };
+    const auto tree = merkle_cache::build(leaves);
+    const auto& root = tree->back().front();
+
+    for (size_t position = 0; position < leaves.size(); ++position)
+    {
+        const auto branch = merkle_cache::branch(*tree, position);
+        BOOST_REQUIRE_EQUAL(branch.size(), 3u);
+        BOOST_REQUIRE(fold(leaves[position], position, branch) == root);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(merkle_cache__find__stored_block__expected)
+{
+    server_node node(configured);
+    merkle_cache cache(node, 2);
+    const auto tree = merkle_cache::build({ leaf(1) });
+    cache.store(leaf(10), tree);
+
+    BOOST_REQUIRE(cache.find(leaf(10)) == tree);
+    BOOST_REQUIRE(!cache.find(leaf(11)));
+}
+
+BOOST_AUTO_TEST_CASE(merkle_cache__store__zero_capacity__not_found)
+{
+    server_node node(configured);
+    merkle_cache cache(node, 0);
+    cache.store(leaf(10), merkle_cache::build({ leaf(1) }));
+    BOOST_REQUIRE(!cache.find(leaf(10)));
+}
+
+BOOST_AUTO_TEST_CASE(merkle_cache__store__over_capacity__least_recent_evicted)
+{
+    server_node node(configured);
+    merkle_cache cache(node, 2);
+    cache.store(leaf(10), merkle_cache::build({ leaf(1) }));
+    cache.store(leaf(11), merkle_cache::build({ leaf(2) }));
+
+    // Finding the first promotes it, so the second is least recently used.
+    BOOST_REQUIRE(cache.find(leaf(10)));
+    cache.store(leaf(12), merkle_cache::build({ leaf(3) }));
+    BOOST_REQUIRE(cache.find(leaf(10)));
+    BOOST_REQUIRE(!cache.find(leaf(11)));
+    BOOST_REQUIRE(cache.find(leaf(12)));
+}
+
+BOOST_AUTO_TEST_CASE(merkle_cache__store__same_block__replaced)
+{
+    server_node node(configured);
+    merkle_cache cache(node, 2);
+    const auto tree = merkle_cache::build({ leaf(2) });
+    cache.store(leaf(10), merkle_cache::build({ leaf(1) }));
+    cache.store(leaf(10), tree);
+    BOOST_REQUIRE(cache.find(leaf(10)) == tree);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
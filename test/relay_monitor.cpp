@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::protocol;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(relay_monitor_tests)
+
+BOOST_AUTO_TEST_CASE(relay_monitor__construct__empty)
+{
+    const relay_monitor monitor;
+    BOOST_REQUIRE_EQUAL(monitor.forwarded_messages(), 0u);
+    BOOST_REQUIRE_EQUAL(monitor.forwarded_bytes(), 0u);
+    BOOST_REQUIRE_EQUAL(monitor.subscriptions(), 0u);
+    BOOST_REQUIRE_EQUAL(monitor.worker_backlog(), 0u);
+    BOOST_REQUIRE_EQUAL(monitor.peak_worker_backlog(), 0u);
+    BOOST_REQUIRE_EQUAL(monitor.serialization().count(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(relay_monitor__stamp__message__timing_frame_appended)
+{
+    relay_monitor monitor;
+    zmq::message message;
+    message.enqueue(data_chunk{ 42 });
+    monitor.stamp(message, asio::steady_clock::now());
+
+    BOOST_REQUIRE_EQUAL(message.size(), 2u);
+    BOOST_REQUIRE_EQUAL(message.dequeue_data().size(), 1u);
+    BOOST_REQUIRE_EQUAL(message.dequeue_data().size(), 2 * sizeof(uint64_t));
+    BOOST_REQUIRE_EQUAL(monitor.serialization().count(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(relay_monitor__backlog__runs__peak_retained)
+{
+    relay_monitor monitor;
+    monitor.backlog(true);
+    monitor.backlog(true);
+    monitor.backlog(true);
+    BOOST_REQUIRE_EQUAL(monitor.worker_backlog(), 3u);
+
+    monitor.backlog(false);
+    monitor.backlog(true);
+    BOOST_REQUIRE_EQUAL(monitor.worker_backlog(), 1u);
+    BOOST_REQUIRE_EQUAL(monitor.peak_worker_backlog(), 3u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,208 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(script_index_tests)
+
+// The node is not started, the index is prepared and linked directly.
+static const configuration configured(config::settings::mainnet);
+static const size_t start_height = configured.database.index_start_height;
+
+// Blocks spend only outputs of the same block, so prepare completes in place.
+class indexer
+  : public script_index
+{
+public:
+    indexer(server_node& node)
+      : script_index(node, configured)
+    {
+    }
+
+    size_t append(block_const_ptr block, size_t height)
+    {
+        auto prepared = false;
+        prepare(block, height, [&](const code& ec) { prepared = !ec; });
+        BOOST_REQUIRE(prepared);
+
+        unique_lock lock(mutex_);
+        return link({ block }, height);
+    }
+
+    bool rollback(size_t fork_height, block_const_ptr block)
+    {
+        unique_lock lock(mutex_);
+        return unlink(fork_height, { block });
+    }
+};
+
+// Bare scripts are distinguished by a pushed byte.
+static chain::script make_script(uint8_t key)
+{
+    return chain::script({ chain::operation(data_chunk{ key }),
+        chain::operation(chain::opcode::drop) });
+}
+
+static hash_digest script_hash(uint8_t key)
+{
+    return script_index::to_script_hash(make_script(key));
+}
+
+static chain::output pay(uint64_t value, uint8_t key)
+{
+    return chain::output(value, make_script(key));
+}
+
+// Coinbase transactions are distinguished by height.
+static chain::transaction coinbase(size_t height, uint64_t value, uint8_t key)
+{
+    const auto sequence = static_cast<uint32_t>(height);
+    const chain::input input(chain::output_point(null_hash,
+        chain::point::null_index), chain::script{}, sequence);
+    return chain::transaction(1, 0, { input }, { pay(value, key) });
+}
+
+static chain::transaction spend(const chain::transaction& parent,
+    chain::output::list&& outputs)
+{
+    const chain::input input(chain::output_point(parent.hash(), 0),
+        chain::script{}, max_input_sequence);
+    return chain::transaction(1, 0, { input }, std::move(outputs));
+}
+
+static block_const_ptr make_block(const hash_digest& previous,
+    chain::transaction::list&& transactions)
+{
+    return std::make_shared<const message::block>(
+        chain::header(1, previous, null_hash, 0, 0, 0),
+        std::move(transactions));
+}
+
+// Script 1 mines 50 and pays 30 of it to script 2, keeping 15 as change.
+static block_const_ptr first_block()
+{
+    const auto mined = coinbase(start_height, 50, 1);
+    const auto paid = spend(mined, { pay(30, 2), pay(15, 1) });
+    return make_block(null_hash, { mined, paid });
+}
+
+// Script 1 mines 10 and pays all of it to script 2.
+static block_const_ptr second_block(const hash_digest& previous)
+{
+    const auto mined = coinbase(start_height + 1, 10, 1);
+    const auto paid = spend(mined, { pay(10, 2) });
+    return make_block(previous, { mined, paid });
+}
+
+static chain::history_compact::list history(const indexer& index,
+    uint8_t key, size_t from_height)
+{
+    size_t height;
+    chain::history_compact::list out;
+    BOOST_REQUIRE(index.history(script_hash(key), from_height, height, out));
+    return out;
+}
+
+static void require_balance(const indexer& index, uint8_t key,
+    uint64_t expected_received, uint64_t expected_spent)
+{
+    size_t height;
+    uint64_t received;
+    uint64_t spent;
+    BOOST_REQUIRE(index.balance(script_hash(key), height, received, spent));
+    BOOST_REQUIRE_EQUAL(received, expected_received);
+    BOOST_REQUIRE_EQUAL(spent, expected_spent);
+}
+
+BOOST_AUTO_TEST_CASE(script_index__history__empty__false)
+{
+    server_node node(configured);
+    indexer index(node);
+    size_t height;
+    chain::history_compact::list out;
+    BOOST_REQUIRE(!index.history(script_hash(1), 0, height, out));
+}
+
+BOOST_AUTO_TEST_CASE(script_index__history__local_spend__rows_in_block_order)
+{
+    server_node node(configured);
+    indexer index(node);
+    const auto block = first_block();
+    const auto& mined = block->transactions()[0];
+    const auto& paid = block->transactions()[1];
+    BOOST_REQUIRE_EQUAL(index.append(block, start_height), 1u);
+
+    const auto rows = history(index, 1, 0);
+    BOOST_REQUIRE_EQUAL(rows.size(), 3u);
+    BOOST_REQUIRE(rows[0].kind == chain::point_kind::output);
+    BOOST_REQUIRE(rows[0].point == chain::point(mined.hash(), 0));
+    BOOST_REQUIRE_EQUAL(rows[0].value, 50u);
+    BOOST_REQUIRE(rows[1].kind == chain::point_kind::spend);
+    BOOST_REQUIRE(rows[1].point == chain::point(paid.hash(), 0));
+    BOOST_REQUIRE_EQUAL(rows[1].previous_checksum,
+        chain::output_point(mined.hash(), 0).checksum());
+    BOOST_REQUIRE(rows[2].kind == chain::point_kind::output);
+    BOOST_REQUIRE(rows[2].point == chain::point(paid.hash(), 1));
+    BOOST_REQUIRE_EQUAL(rows[2].height, start_height);
+
+    require_balance(index, 1, 65, 50);
+    require_balance(index, 2, 30, 0);
+}
+
+BOOST_AUTO_TEST_CASE(script_index__history__from_height__filtered)
+{
+    server_node node(configured);
+    indexer index(node);
+    const auto first = first_block();
+    const auto second = second_block(first->header().hash());
+    BOOST_REQUIRE_EQUAL(index.append(first, start_height), 1u);
+    BOOST_REQUIRE_EQUAL(index.append(second, start_height + 1), 1u);
+
+    BOOST_REQUIRE_EQUAL(history(index, 1, 0).size(), 5u);
+    const auto rows = history(index, 2, start_height + 1);
+    BOOST_REQUIRE_EQUAL(rows.size(), 1u);
+    BOOST_REQUIRE_EQUAL(rows[0].height, start_height + 1);
+    BOOST_REQUIRE_EQUAL(rows[0].value, 10u);
+}
+
+BOOST_AUTO_TEST_CASE(script_index__history__disconnected__restored)
+{
+    server_node node(configured);
+    indexer index(node);
+    const auto first = first_block();
+    const auto second = second_block(first->header().hash());
+    BOOST_REQUIRE_EQUAL(index.append(first, start_height), 1u);
+    BOOST_REQUIRE_EQUAL(index.append(second, start_height + 1), 1u);
+    require_balance(index, 1, 75, 60);
+    require_balance(index, 2, 40, 0);
+
+    BOOST_REQUIRE(index.rollback(start_height, second));
+    BOOST_REQUIRE_EQUAL(history(index, 1, 0).size(), 3u);
+    BOOST_REQUIRE_EQUAL(history(index, 2, 0).size(), 1u);
+    require_balance(index, 1, 65, 50);
+    require_balance(index, 2, 30, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
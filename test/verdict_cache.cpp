@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <thread>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(verdict_cache_tests)
+
+static hash_digest key(uint8_t value)
+{
+    hash_digest hash{};
+    hash.front() = value;
+    return hash;
+}
+
+// The node is not started, it only provides the reorganization subscriber.
+static const configuration configured(config::settings::mainnet);
+
+BOOST_AUTO_TEST_CASE(verdict_cache__enabled__zero_capacity__false)
+{
+    server_node node(configured);
+    verdict_cache cache(node, 0, asio::seconds(60));
+    BOOST_REQUIRE(!cache.enabled());
+
+    code verdict;
+    cache.store(key(1), error::success);
+    BOOST_REQUIRE(!cache.find(key(1), verdict));
+}
+
+BOOST_AUTO_TEST_CASE(verdict_cache__enabled__zero_lifetime__false)
+{
+    server_node node(configured);
+    verdict_cache cache(node, 10, asio::duration::zero());
+    BOOST_REQUIRE(!cache.enabled());
+}
+
+BOOST_AUTO_TEST_CASE(verdict_cache__find__stored__expected)
+{
+    server_node node(configured);
+    verdict_cache cache(node, 10, asio::seconds(60));
+    BOOST_REQUIRE(cache.enabled());
+
+    code verdict = error::not_found;
+    cache.store(key(1), error::success);
+    BOOST_REQUIRE(cache.find(key(1), verdict));
+    BOOST_REQUIRE(!verdict);
+    BOOST_REQUIRE(!cache.find(key(2), verdict));
+}
+
+BOOST_AUTO_TEST_CASE(verdict_cache__store__over_capacity__oldest_evicted)
+{
+    server_node node(configured);
+    verdict_cache cache(node, 2, asio::seconds(60));
+
+    code verdict;
+    cache.store(key(1), error::success);
+    cache.store(key(2), error::success);
+    cache.store(key(3), error::success);
+    BOOST_REQUIRE(!cache.find(key(1), verdict));
+    BOOST_REQUIRE(cache.find(key(2), verdict));
+    BOOST_REQUIRE(cache.find(key(3), verdict));
+}
+
+BOOST_AUTO_TEST_CASE(verdict_cache__store__restored__newest_retained)
+{
+    server_node node(configured);
+    verdict_cache cache(node, 2, asio::seconds(60));
+
+    code verdict;
+    cache.store(key(1), error::success);
+    cache.store(key(2), error::success);
+
+    // The restored entry is distinct from its queued predecessor by expiry.
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    cache.store(key(1), error::success);
+    cache.store(key(3), error::success);
+    BOOST_REQUIRE(cache.find(key(1), verdict));
+    BOOST_REQUIRE(!cache.find(key(2), verdict));
+    BOOST_REQUIRE(cache.find(key(3), verdict));
+}
+
+BOOST_AUTO_TEST_CASE(verdict_cache__find__expired__false)
+{
+    server_node node(configured);
+    verdict_cache cache(node, 10, asio::milliseconds(1));
+
+    code verdict;
+    cache.store(key(1), error::success);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    BOOST_REQUIRE(!cache.find(key(1), verdict));
+}
+
+BOOST_AUTO_TEST_SUITE_END()